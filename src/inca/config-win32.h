@@ -42,5 +42,6 @@ typedef long clock_t;
 #define HAVE_LIBFFTW3F  1
 //#define HAVE_LIBFFTW3   1
 //#define HAVE_LIBFFTW3L  0
+//#define HAVE_LIBFFTW3F_THREADS  1   // Requires vcpkg's fftw3[threads]
 
 #endif
@@ -9,6 +9,27 @@
  *      This file implements the discrete Fourier transform algorithms
  *      used by the DFT raster operators defined in
  *      inca/raster/operators/fourier using the FFTW library.
+ *
+ *      FFTW plans are expensive to create (especially with the MEASURE and
+ *      PATIENT planning modes), but can be reused for any pair of arrays
+ *      having the same sizes and alignment via FFTW's "new-array execute"
+ *      interface. We therefore keep a process-wide cache of plans, keyed by
+ *      precision, direction, sizes and alignment, and only invoke the planner
+ *      the first time a particular transform is requested. Access to the
+ *      planner (which is not thread-safe) is serialized with a mutex;
+ *      executing a plan is thread-safe, and is done outside the lock.
+ *
+ *      Accumulated FFTW "wisdom" may be saved to and restored from files, so
+ *      that the (possibly lengthy) planning need not be repeated in every
+ *      process. As with FFTW's own system wisdom files, each precision is
+ *      stored in a separate file: the given filename is used for double
+ *      precision, and 'f' and 'l' are appended to it for single and
+ *      long-double precision, respectively.
+ *
+ *      If FFTW's threading library is available for a precision (indicated
+ *      by HAVE_LIBFFTW3F_THREADS, etc.), large transforms can be spread
+ *      across several threads; see setDFTThreadCount(). The thread count is
+ *      part of the plan cache key, since FFTW fixes it at planning time.
  */
 
 // Include precompiled header
@@ -23,147 +44,540 @@ using namespace inca::raster;
 #include <complex>
 #include <fftw3.h>
 
+// Import containers & synchronization primitives for the plan cache
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+
+// Import preprocessor looping macros (we specialize for ranks 1 - MAX_DIM)
+#include <inca/util/multi-dimensional-macros.hpp>
+
 // This won't link with the FFTW library if we compile as "managed" code
 #pragma unmanaged
 
 namespace inca {
     namespace raster {
 
-// Specializations for IEEE single-precision floating point numbers
-#ifdef HAVE_LIBFFTW3F
+    // Traits class wrapping the precision-specific FFTW API. This is only
+    // specialized for those precisions for which FFTW is available.
+    template <typename T> struct fftw_api;
 
-    // Complex data type
-    typedef std::complex<float> cmplx_f;
+#ifdef HAVE_LIBFFTW3F
+    template <>
+    struct fftw_api<float> {
+        typedef fftwf_plan      Plan;
+        typedef fftwf_complex   Complex;
+        static const char * wisdomSuffix() { return "f"; }
+        static void * malloc(size_t n)  { return fftwf_malloc(n); }
+        static void   free(void * p)    { fftwf_free(p); }
+        static int alignmentOf(void * p) { return fftwf_alignment_of(static_cast<float *>(p)); }
+        static Plan planR2C(int rank, const int * n, float * in, Complex * out, unsigned flags) {
+            return fftwf_plan_dft_r2c(rank, n, in, out, flags);
+        }
+        static Plan planC2R(int rank, const int * n, Complex * in, float * out, unsigned flags) {
+            return fftwf_plan_dft_c2r(rank, n, in, out, flags);
+        }
+        static Plan planC2C(int rank, const int * n, Complex * in, Complex * out, int sign, unsigned flags) {
+            return fftwf_plan_many_dft(rank, n, 1, in, NULL, 1, 0, out, NULL, 1, 0, sign, flags);
+        }
+        static void executeR2C(Plan p, float * in, Complex * out) { fftwf_execute_dft_r2c(p, in, out); }
+        static void executeC2R(Plan p, Complex * in, float * out) { fftwf_execute_dft_c2r(p, in, out); }
+        static void executeC2C(Plan p, Complex * in, Complex * out) { fftwf_execute_dft(p, in, out); }
+        static void destroy(Plan p) { fftwf_destroy_plan(p); }
+        static bool importWisdom(const char * f) { return fftwf_import_wisdom_from_filename(f) != 0; }
+        static bool exportWisdom(const char * f) { return fftwf_export_wisdom_to_filename(f) != 0; }
+#ifdef HAVE_LIBFFTW3F_THREADS
+        static bool initThreads()           { return fftwf_init_threads() != 0; }
+        static void planWithThreads(int n)  { fftwf_plan_with_nthreads(n); }
+        static void cleanupThreads()        { fftwf_cleanup_threads(); }
+#else
+        static bool initThreads()           { return false; }
+        static void planWithThreads(int n)  { }
+        static void cleanupThreads()        { }
+#endif
+    };
+#endif
 
-    // Memory allocation functions
+#ifdef HAVE_LIBFFTW3
     template <>
-    float * dft_memory_allocate<float>(inca::SizeType n) {
-        return (float *) fftwf_malloc(sizeof(float) * n);
-    }
+    struct fftw_api<double> {
+        typedef fftw_plan       Plan;
+        typedef fftw_complex    Complex;
+        static const char * wisdomSuffix() { return ""; }
+        static void * malloc(size_t n)  { return fftw_malloc(n); }
+        static void   free(void * p)    { fftw_free(p); }
+        static int alignmentOf(void * p) { return fftw_alignment_of(static_cast<double *>(p)); }
+        static Plan planR2C(int rank, const int * n, double * in, Complex * out, unsigned flags) {
+            return fftw_plan_dft_r2c(rank, n, in, out, flags);
+        }
+        static Plan planC2R(int rank, const int * n, Complex * in, double * out, unsigned flags) {
+            return fftw_plan_dft_c2r(rank, n, in, out, flags);
+        }
+        static Plan planC2C(int rank, const int * n, Complex * in, Complex * out, int sign, unsigned flags) {
+            return fftw_plan_many_dft(rank, n, 1, in, NULL, 1, 0, out, NULL, 1, 0, sign, flags);
+        }
+        static void executeR2C(Plan p, double * in, Complex * out) { fftw_execute_dft_r2c(p, in, out); }
+        static void executeC2R(Plan p, Complex * in, double * out) { fftw_execute_dft_c2r(p, in, out); }
+        static void executeC2C(Plan p, Complex * in, Complex * out) { fftw_execute_dft(p, in, out); }
+        static void destroy(Plan p) { fftw_destroy_plan(p); }
+        static bool importWisdom(const char * f) { return fftw_import_wisdom_from_filename(f) != 0; }
+        static bool exportWisdom(const char * f) { return fftw_export_wisdom_to_filename(f) != 0; }
+#ifdef HAVE_LIBFFTW3_THREADS
+        static bool initThreads()           { return fftw_init_threads() != 0; }
+        static void planWithThreads(int n)  { fftw_plan_with_nthreads(n); }
+        static void cleanupThreads()        { fftw_cleanup_threads(); }
+#else
+        static bool initThreads()           { return false; }
+        static void planWithThreads(int n)  { }
+        static void cleanupThreads()        { }
+#endif
+    };
+#endif
+
+#ifdef HAVE_LIBFFTW3L
     template <>
-    cmplx_f * dft_memory_allocate<cmplx_f>(inca::SizeType n) {
-        return (cmplx_f *) fftwf_malloc(sizeof(cmplx_f) * n);
-    }
+    struct fftw_api<long double> {
+        typedef fftwl_plan      Plan;
+        typedef fftwl_complex   Complex;
+        static const char * wisdomSuffix() { return "l"; }
+        static void * malloc(size_t n)  { return fftwl_malloc(n); }
+        static void   free(void * p)    { fftwl_free(p); }
+        static int alignmentOf(void * p) { return fftwl_alignment_of(static_cast<long double *>(p)); }
+        static Plan planR2C(int rank, const int * n, long double * in, Complex * out, unsigned flags) {
+            return fftwl_plan_dft_r2c(rank, n, in, out, flags);
+        }
+        static Plan planC2R(int rank, const int * n, Complex * in, long double * out, unsigned flags) {
+            return fftwl_plan_dft_c2r(rank, n, in, out, flags);
+        }
+        static Plan planC2C(int rank, const int * n, Complex * in, Complex * out, int sign, unsigned flags) {
+            return fftwl_plan_many_dft(rank, n, 1, in, NULL, 1, 0, out, NULL, 1, 0, sign, flags);
+        }
+        static void executeR2C(Plan p, long double * in, Complex * out) { fftwl_execute_dft_r2c(p, in, out); }
+        static void executeC2R(Plan p, Complex * in, long double * out) { fftwl_execute_dft_c2r(p, in, out); }
+        static void executeC2C(Plan p, Complex * in, Complex * out) { fftwl_execute_dft(p, in, out); }
+        static void destroy(Plan p) { fftwl_destroy_plan(p); }
+        static bool importWisdom(const char * f) { return fftwl_import_wisdom_from_filename(f) != 0; }
+        static bool exportWisdom(const char * f) { return fftwl_export_wisdom_to_filename(f) != 0; }
+#ifdef HAVE_LIBFFTW3L_THREADS
+        static bool initThreads()           { return fftwl_init_threads() != 0; }
+        static void planWithThreads(int n)  { fftwl_plan_with_nthreads(n); }
+        static void cleanupThreads()        { fftwl_cleanup_threads(); }
+#else
+        static bool initThreads()           { return false; }
+        static void planWithThreads(int n)  { }
+        static void cleanupThreads()        { }
+#endif
+    };
+#endif
 
-    // Memory deallocation functions
-    template <> void dft_memory_deallocate<cmplx_f>(cmplx_f * p) { fftwf_free(p); }
-    template <> void dft_memory_deallocate<float>(float * p) { fftwf_free(p); }
 
-    // Transformation functions
-    template <>
-    void dft_forward_transform<float, 2>(const Array<SizeType, 2> & sizes,
-                                         cmplx_f * out, float const * in) {
-        fftwf_plan p = fftwf_plan_dft_r2c_2d(sizes[0], sizes[1],
-                                            const_cast<float *>(in),
-                                            reinterpret_cast<fftwf_complex *>(out),
-                                            FFTW_ESTIMATE);
-        fftwf_execute(p);
-        fftwf_destroy_plan(p);
+    // The FFTW planner is not thread-safe, so all planner activity (plan
+    // creation & destruction, wisdom import & export) goes through this lock
+    static std::mutex & plannerMutex() {
+        static std::mutex m;
+        return m;
     }
-    template <>
-    void dft_backward_transform<float, 2>(const Array<SizeType, 2> & sizes,
-                                          float * out, cmplx_f const * in) {
-        fftwf_plan p = fftwf_plan_dft_c2r_2d(sizes[0], sizes[1],
-                                            reinterpret_cast<fftwf_complex *>(
-                                                const_cast<cmplx_f *>(in)),
-                                            out,
-                                            FFTW_ESTIMATE);
-        fftwf_execute(p);
-        fftwf_destroy_plan(p);
+
+    // Current planning rigor, wisdom file, thread count and in-place mode
+    static DFTPlanningRigor planningRigor = DFTEstimate;
+    static std::string      wisdomFilename;
+    static SizeType         threadCount = 1;
+    static bool             inPlaceMode = true;
+
+    // Translate our planning rigor into FFTW planner flags
+    static unsigned plannerFlags(DFTPlanningRigor r) {
+        switch (r) {
+            case DFTMeasure:    return FFTW_MEASURE;
+            case DFTPatient:    return FFTW_PATIENT;
+            case DFTExhaustive: return FFTW_EXHAUSTIVE;
+            case DFTEstimate:
+            default:            return FFTW_ESTIMATE;
+        }
     }
 
-#endif
 
+    // The plan cache for a single precision. Each cached plan is identified
+    // by the direction and logical sizes of the transform, plus whether the
+    // arrays it will be executed on have FFTW's preferred (SIMD) alignment,
+    // whether the transform is in-place, and how many threads it uses.
+    template <typename T>
+    class DFTPlanCache {
+    public:
+        typedef fftw_api<T>             API;
+        typedef typename API::Plan      Plan;
+        typedef typename API::Complex   Complex;
+
+        // The kind of transform: real-to-complex (Forward), complex-to-real
+        // (Backward) or complex-to-complex in either direction
+        enum Direction { Forward, Backward, ComplexForward, ComplexBackward };
+
+        struct Key {
+            Direction           direction;
+            std::vector<int>    sizes;
+            bool                aligned;
+            bool                inPlace;
+            int                 threads;
+
+            bool operator<(const Key & k) const {
+                if (direction != k.direction)   return direction < k.direction;
+                if (threads != k.threads)       return threads < k.threads;
+                if (aligned != k.aligned)       return aligned < k.aligned;
+                if (inPlace != k.inPlace)       return inPlace < k.inPlace;
+                return sizes < k.sizes;
+            }
+        };
 
-// Specializations for IEEE double-precision floating point numbers
-#ifdef HAVE_LIBFFTW3
+        // The one instance for this precision
+        static DFTPlanCache & instance() {
+            static DFTPlanCache cache;
+            return cache;
+        }
 
-    // Complex data type
-    typedef std::complex<double> cmplx_d;
+        DFTPlanCache() : threadsInitialized(false), threadsAvailable(false) { }
+        ~DFTPlanCache() {
+            clear();
+            if (threadsAvailable)
+                API::cleanupThreads();
+        }
 
-    // Memory allocation functions
-    template <>
-    double * dft_memory_allocate<double>(inca::SizeType n) {
-        return (double *) fftw_malloc(sizeof(double) * n);
+        // Find (or create) a plan suitable for transforming between 'in' and
+        // 'out'. The returned plan may only be used with the new-array execute
+        // functions. The caller must hold the planner lock.
+        Plan plan(Direction dir, const std::vector<int> & sizes,
+                  void * in, void * out) {
+            Key key;
+            key.direction = dir;
+            key.sizes     = sizes;
+            key.inPlace   = (in == out);
+            key.aligned   = API::alignmentOf(in) == 0 && API::alignmentOf(out) == 0;
+            key.threads   = plannerThreads();
+
+            typename std::map<Key, Plan>::iterator it = plans.find(key);
+            if (it != plans.end())
+                return it->second;
+
+            // Anything other than ESTIMATE scribbles over the arrays while
+            // planning, so we plan on scratch arrays of the same shape.
+            // Real-to-complex transforms use (n/2 + 1) complex elements along
+            // the last dimension, and an in-place real array is padded to match.
+            bool complexToComplex = (dir == ComplexForward || dir == ComplexBackward);
+            size_t realCount = 1;
+            for (size_t d = 0; d < sizes.size(); ++d)
+                realCount *= sizes[d];
+            size_t complexCount = complexToComplex ? realCount
+                                : realCount / sizes.back() * (sizes.back() / 2 + 1);
+            size_t complexBytes = complexCount * sizeof(Complex);
+            size_t realBytes    = complexToComplex ? complexBytes : realCount * sizeof(T);
+
+            void * scratchIn  = API::malloc(key.inPlace ? std::max(realBytes, complexBytes)
+                                                        : (dir == Backward ? complexBytes : realBytes));
+            void * scratchOut = key.inPlace ? scratchIn
+                                            : API::malloc(dir == Forward ? complexBytes : realBytes);
+
+            unsigned flags = plannerFlags(planningRigor);
+            if (! key.aligned)
+                flags |= FFTW_UNALIGNED;
+
+            // Only touch FFTW's threading state if we're using threads
+            if (threadsAvailable)
+                API::planWithThreads(key.threads);
+
+            int rank = int(sizes.size());
+            Plan p;
+            switch (dir) {
+            case Forward:
+                p = API::planR2C(rank, &sizes[0], static_cast<T *>(scratchIn),
+                                 static_cast<Complex *>(scratchOut), flags);
+                break;
+            case Backward:
+                p = API::planC2R(rank, &sizes[0], static_cast<Complex *>(scratchIn),
+                                 static_cast<T *>(scratchOut), flags);
+                break;
+            case ComplexForward:
+            case ComplexBackward:
+                p = API::planC2C(rank, &sizes[0], static_cast<Complex *>(scratchIn),
+                                 static_cast<Complex *>(scratchOut),
+                                 dir == ComplexForward ? FFTW_FORWARD : FFTW_BACKWARD,
+                                 flags);
+                break;
+            }
+
+            API::free(scratchIn);
+            if (! key.inPlace)
+                API::free(scratchOut);
+
+            plans[key] = p;
+            return p;
+        }
+
+        // How many plans are cached. The caller must hold the planner lock.
+        SizeType size() const { return SizeType(plans.size()); }
+
+        // Destroy all of the cached plans. The caller must hold the planner lock.
+        void clear() {
+            typename std::map<Key, Plan>::iterator it;
+            for (it = plans.begin(); it != plans.end(); ++it)
+                API::destroy(it->second);
+            plans.clear();
+        }
+
+    protected:
+        // How many threads new plans should use. FFTW's threading support
+        // is initialized the first time more than one thread is requested;
+        // if that fails (or this precision was built without it), we quietly
+        // fall back to single-threaded plans.
+        int plannerThreads() {
+            SizeType n = threadCount;
+            if (n <= 0) {
+                n = SizeType(std::thread::hardware_concurrency());
+                if (n <= 0)
+                    n = 1;
+            }
+            if (n > 1 && ! threadsInitialized) {
+                threadsInitialized = true;
+                threadsAvailable   = API::initThreads();
+                if (! threadsAvailable)
+                    INCA_WARNING("FFTW threads are unavailable: DFTs will be single-threaded");
+            }
+            return threadsAvailable ? int(n) : 1;
+        }
+
+        std::map<Key, Plan> plans;
+        bool threadsInitialized, threadsAvailable;
+    };
+
+
+    // Convert our sizes into the int array that FFTW wants. FFTW expects
+    // row-major (C) ordering, where the last dimension varies fastest.
+    template <SizeType dim>
+    static std::vector<int> fftwSizes(const Array<SizeType, dim> & sizes) {
+        return std::vector<int>(sizes.begin(), sizes.end());
     }
-    template <>
-    cmplx_d * dft_memory_allocate<cmplx_d>(inca::SizeType n) {
-        return (cmplx_d *) fftw_malloc(sizeof(cmplx_d) * n);
+
+    // Generic real-to-complex, complex-to-real and complex-to-complex
+    // transforms using the cache
+    template <typename T, SizeType dim>
+    static void forwardTransform(const Array<SizeType, dim> & sizes,
+                                 std::complex<T> * out, T const * in) {
+        typedef DFTPlanCache<T> Cache;
+        T * i = const_cast<T *>(in);
+        typename Cache::Complex * o = reinterpret_cast<typename Cache::Complex *>(out);
+        typename Cache::Plan p;
+        {
+            std::lock_guard<std::mutex> lock(plannerMutex());
+            p = Cache::instance().plan(Cache::Forward, fftwSizes(sizes), i, o);
+        }
+        fftw_api<T>::executeR2C(p, i, o);
+    }
+    template <typename T, SizeType dim>
+    static void backwardTransform(const Array<SizeType, dim> & sizes,
+                                  T * out, std::complex<T> const * in) {
+        typedef DFTPlanCache<T> Cache;
+        typename Cache::Complex * i = reinterpret_cast<typename Cache::Complex *>(
+                                            const_cast<std::complex<T> *>(in));
+        typename Cache::Plan p;
+        {
+            std::lock_guard<std::mutex> lock(plannerMutex());
+            p = Cache::instance().plan(Cache::Backward, fftwSizes(sizes), i, out);
+        }
+        fftw_api<T>::executeC2R(p, i, out);
     }
 
-    // Memory deallocation functions
-    template <> void dft_memory_deallocate<double>(double * p) { fftw_free(p); }
-    template <> void dft_memory_deallocate<cmplx_d>(cmplx_d * p) { fftw_free(p); }
+    template <typename T, SizeType dim>
+    static void complexTransform(const Array<SizeType, dim> & sizes,
+                                 std::complex<T> * out, std::complex<T> const * in,
+                                 bool inverse) {
+        typedef DFTPlanCache<T> Cache;
+        typename Cache::Complex * i = reinterpret_cast<typename Cache::Complex *>(
+                                            const_cast<std::complex<T> *>(in));
+        typename Cache::Complex * o = reinterpret_cast<typename Cache::Complex *>(out);
+        typename Cache::Plan p;
+        {
+            std::lock_guard<std::mutex> lock(plannerMutex());
+            p = Cache::instance().plan(inverse ? Cache::ComplexBackward
+                                               : Cache::ComplexForward,
+                                       fftwSizes(sizes), i, o);
+        }
+        fftw_api<T>::executeC2C(p, i, o);
+    }
 
-    // Transformation functions
-    template <>
-    void dft_forward_transform<double, 2>(const Array<SizeType, 2> & sizes,
-                                          cmplx_d * out, double const * in) {
-        fftw_plan p = fftw_plan_dft_r2c_2d(sizes[0], sizes[1],
-                                            const_cast<double *>(in),
-                                            reinterpret_cast<fftw_complex *>(out),
-                                            FFTW_ESTIMATE);
-        fftw_execute(p);
-        fftw_destroy_plan(p);
+    // Per-precision wisdom & cache management helpers
+    template <typename T>
+    static bool importWisdom(const std::string & filename) {
+        return fftw_api<T>::importWisdom((filename + fftw_api<T>::wisdomSuffix()).c_str());
     }
-    template <>
-    void dft_backward_transform<double, 2>(const Array<SizeType, 2> & sizes,
-                                           double * out, cmplx_d const * in) {
-        fftw_plan p = fftw_plan_dft_c2r_2d(sizes[0], sizes[1],
-                                        reinterpret_cast<fftw_complex *>(
-                                            const_cast<cmplx_d *>(in)),
-                                        out,
-                                        FFTW_ESTIMATE);
-        fftw_execute(p);
-        fftw_destroy_plan(p);
+    template <typename T>
+    static bool exportWisdom(const std::string & filename) {
+        return fftw_api<T>::exportWisdom((filename + fftw_api<T>::wisdomSuffix()).c_str());
     }
 
-#endif
 
+    // Write out the wisdom file (if one was requested) when the process exits
+    struct WisdomSaver {
+        ~WisdomSaver() {
+            if (! wisdomFilename.empty())
+                exportDFTWisdom(wisdomFilename);
+        }
+    };
 
-// Specializations for IEEE long-double-precision floating point numbers
-#ifdef HAVE_LIBFFTW3L
 
-    // Complex data type
-    typedef std::complex<long double> cmplx_l;
+    // Planning rigor accessors
+    void setDFTPlanningRigor(DFTPlanningRigor r) {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        planningRigor = r;
+    }
+    DFTPlanningRigor dftPlanningRigor() {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        return planningRigor;
+    }
 
-    // Memory allocation functions
-    template <>
-    long double * dft_memory_allocate<long double>(inca::SizeType n) {
-        return (long double *) fftwl_malloc(sizeof(long double) * n);
+    // Threading & in-place accessors
+    void setDFTThreadCount(SizeType n) {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        threadCount = (n < 0 ? 0 : n);
     }
-    template <>
-    cmplx_l * dft_memory_allocate<cmplx_l>(inca::SizeType n) {
-        return (cmplx_l *) fftwl_malloc(sizeof(cmplx_l) * n);
+    SizeType dftThreadCount() {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        return threadCount;
+    }
+    void setDFTInPlace(bool inPlace) {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        inPlaceMode = inPlace;
+    }
+    bool dftInPlace() {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        return inPlaceMode;
     }
 
-    // Memory deallocation functions
-    template <> void dft_memory_deallocate<long double>(long double * p) { fftwl_free(p); }
-    template <> void dft_memory_deallocate<cmplx_l>(cmplx_l * p) { fftwl_free(p); }
+    // Wisdom persistence functions
+    bool importDFTWisdom(const std::string & filename) {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        bool success = true;
+#ifdef HAVE_LIBFFTW3F
+        success = importWisdom<float>(filename) && success;
+#endif
+#ifdef HAVE_LIBFFTW3
+        success = importWisdom<double>(filename) && success;
+#endif
+#ifdef HAVE_LIBFFTW3L
+        success = importWisdom<long double>(filename) && success;
+#endif
+        return success;
+    }
+    bool exportDFTWisdom(const std::string & filename) {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        bool success = true;
+#ifdef HAVE_LIBFFTW3F
+        success = exportWisdom<float>(filename) && success;
+#endif
+#ifdef HAVE_LIBFFTW3
+        success = exportWisdom<double>(filename) && success;
+#endif
+#ifdef HAVE_LIBFFTW3L
+        success = exportWisdom<long double>(filename) && success;
+#endif
+        if (! success)
+            INCA_WARNING("exportDFTWisdom(" << filename << "): could not write wisdom");
+        return success;
+    }
+    void setDFTWisdomFile(const std::string & filename) {
+        // The saver must be destroyed before the lock it uses, so make sure
+        // the lock is constructed first
+        plannerMutex();
+        static WisdomSaver saver;   // Constructed on first use, destroyed at exit
+        {
+            std::lock_guard<std::mutex> lock(plannerMutex());
+            wisdomFilename = filename;
+        }
+        if (! filename.empty())
+            importDFTWisdom(filename);  // It's OK if this doesn't exist yet
+    }
 
-    // Transformation functions
-    template <>
-    void dft_forward_transform<long double, 2>(const Array<SizeType, 2> & sizes,
-                                               cmplx_l * out, long double const * in) {
-        fftwl_plan p = fftwl_plan_dft_r2c_2d(sizes[0], sizes[1],
-                                            const_cast<long double *>(in),
-                                            reinterpret_cast<fftwl_complex *>(out),
-                                            FFTW_ESTIMATE);
-        fftwl_execute(p);
-        fftwl_destroy_plan(p);
+    // Throw away (or count) all cached plans
+    void clearDFTPlanCache() {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+#ifdef HAVE_LIBFFTW3F
+        DFTPlanCache<float>::instance().clear();
+#endif
+#ifdef HAVE_LIBFFTW3
+        DFTPlanCache<double>::instance().clear();
+#endif
+#ifdef HAVE_LIBFFTW3L
+        DFTPlanCache<long double>::instance().clear();
+#endif
     }
-    template <>
-    void dft_backward_transform<long double, 2>(const Array<SizeType, 2> & sizes,
-                                                long double * out, cmplx_l const * in) {
-        fftwl_plan p = fftwl_plan_dft_c2r_2d(sizes[0], sizes[1],
-                                            reinterpret_cast<fftwl_complex *>(
-                                                const_cast<cmplx_l *>(in)),
-                                            out,
-                                            FFTW_ESTIMATE);
-        fftwl_execute(p);
-        fftwl_destroy_plan(p);
+    SizeType dftPlanCount() {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        SizeType n = 0;
+#ifdef HAVE_LIBFFTW3F
+        n += DFTPlanCache<float>::instance().size();
+#endif
+#ifdef HAVE_LIBFFTW3
+        n += DFTPlanCache<double>::instance().size();
+#endif
+#ifdef HAVE_LIBFFTW3L
+        n += DFTPlanCache<long double>::instance().size();
+#endif
+        return n;
+    }
+
+
+// This macro generates the explicit specializations of the transformation
+// functions for a single precision T and rank DIM.
+#define INCA_DFT_SPECIALIZATIONS(Z, DIM, T)                                 \
+    template <>                                                             \
+    void dft_forward_transform<T, DIM>(const Array<SizeType, DIM> & sizes,  \
+                                       std::complex<T> * out,               \
+                                       T const * in) {                      \
+        forwardTransform(sizes, out, in);                                   \
+    }                                                                       \
+    template <>                                                             \
+    void dft_backward_transform<T, DIM>(const Array<SizeType, DIM> & sizes, \
+                                        T * out,                            \
+                                        std::complex<T> const * in) {       \
+        backwardTransform(sizes, out, in);                                  \
+    }                                                                       \
+    template <>                                                             \
+    void dft_forward_transform<T, DIM>(const Array<SizeType, DIM> & sizes,  \
+                                       std::complex<T> * out,               \
+                                       std::complex<T> const * in) {        \
+        complexTransform(sizes, out, in, false);                            \
+    }                                                                       \
+    template <>                                                             \
+    void dft_backward_transform<T, DIM>(const Array<SizeType, DIM> & sizes, \
+                                        std::complex<T> * out,              \
+                                        std::complex<T> const * in) {       \
+        complexTransform(sizes, out, in, true);                             \
     }
 
+
+// Specializations for IEEE single-precision floating point numbers
+#ifdef HAVE_LIBFFTW3F
+
+    // Transformation functions (for every supported rank)
+    FOR_RANGE(1, MAX_DIM, INCA_DFT_SPECIALIZATIONS, float)
+
+#endif
+
+
+// Specializations for IEEE double-precision floating point numbers
+#ifdef HAVE_LIBFFTW3
+
+    // Transformation functions (for every supported rank)
+    FOR_RANGE(1, MAX_DIM, INCA_DFT_SPECIALIZATIONS, double)
+
+#endif
+
+
+// Specializations for IEEE long-double-precision floating point numbers
+#ifdef HAVE_LIBFFTW3L
+
+    // Transformation functions (for every supported rank)
+    FOR_RANGE(1, MAX_DIM, INCA_DFT_SPECIALIZATIONS, long double)
+
 #endif
 
     }
@@ -6,42 +6,390 @@
  * Copyright 2002, Ryan L. Saunders. All rights reserved.
  *
  * Description:
+ *      The ImageCodec class is the abstract base class for the image file
+ *      formats understood by the Inca I/O subsystem. A codec knows how to
+ *      recognize, read and write the header of one family of file formats;
+ *      everything after the header is the same for all of them: rows of
+ *      uncompressed, interleaved samples, which the ImageReader/ImageWriter
+ *      classes (see inca/raster/algorithms/image_io) stream directly into
+ *      and out of rasters.
+ *
+ *      The ImageFormat struct describes the layout of an image file: its
+ *      size, the number of channels, the type, range and byte order of its
+ *      samples, and whether its rows are stored top-to-bottom (as usual) or
+ *      bottom-to-top.
+ *
+ *      The following codecs are provided:
+ *          PNMImageCodec -- binary PGM (P5) and PPM (P6) files, with 8 or 16
+ *                           bit samples (the plain-text variants, P2 & P3,
+ *                           are not supported)
+ *          PFMImageCodec -- PFM files, with 32-bit floating-point samples,
+ *                           stored bottom-to-top
+ *          RawImageCodec -- a minimal "INCAIMG" text header, followed by
+ *                           8/16-bit integer or 32-bit float samples with any
+ *                           number of channels, in either byte order
+ *
+ *      Codecs are stateless, and a single instance of each is shared by
+ *      everyone (see ImageCodec::pnm(), etc.). ImageCodec::forFilename()
+ *      picks one by file extension (for writing), and forStream() picks one
+ *      by looking at the first few bytes of the file (for reading). Problems
+ *      are reported by throwing an InvalidFileTypeException (for a file that
+ *      isn't in any format we know) or a FileFormatException (for a damaged
+ *      one).
  */
 
 #pragma once
 #ifndef INCA_IO_IMAGE_CODEC
 #define INCA_IO_IMAGE_CODEC
 
+// Import system configuration
+#include <inca/inca-common.h>
+
 
 // This is part of the Inca I/O subsystem
 namespace inca {
     namespace io {
         // Forward declarations
+        struct ImageFormat;
         class ImageCodec;
+        class PNMImageCodec;
+        class PFMImageCodec;
+        class RawImageCodec;
+
+        // The types of samples that may be stored in an image file
+        enum ImageSampleType {
+            UInt8Samples,       // 8-bit unsigned integers
+            UInt16Samples,      // 16-bit unsigned integers
+            Float32Samples,     // 32-bit IEEE floating-point numbers
+        };
     };
 };
 
 
-class inca::io::ImageCodec {
-public:
-    // Constructors
-    explicit InvalidReferenceException(const std::string & file,
-                                       const std::string & ID,
-                                       const std::string & msg = std::string())
-                        : FileFormatException(file, msg), _id(ID) {
-        _reference = filename() + '#' + id();
-//        *this << reference << ": " << message;
+// Import exception definitions
+#include "FileExceptions.hpp"
+
+// Import I/O streams and string utilities
+#include <istream>
+#include <ostream>
+#include <string>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+
+struct inca::io::ImageFormat {
+    // Constructor
+    explicit ImageFormat(SizeType w = 0, SizeType h = 0, SizeType ch = 1,
+                         ImageSampleType st = UInt8Samples)
+        : width(w), height(h), channels(ch), sampleType(st),
+          maxValue(st == UInt16Samples ? 65535 : st == UInt8Samples ? 255 : 1),
+          bigEndian(nativeBigEndian()), bottomUp(false) { }
+
+    // Is this machine big-endian?
+    static bool nativeBigEndian() {
+        const unsigned short one = 1;
+        return *reinterpret_cast<const unsigned char *>(&one) == 0;
+    }
+
+    // How big is each sample/row (in bytes)?
+    SizeType sampleSize() const {
+        return sampleType == UInt8Samples ? 1 : sampleType == UInt16Samples ? 2 : 4;
+    }
+    SizeType rowSize() const { return width * channels * sampleSize(); }
+
+    // Does reading/writing this file require byte-swapping?
+    bool needsByteSwap() const {
+        return sampleSize() > 1 && bigEndian != nativeBigEndian();
     }
 
+    SizeType        width, height;  // How many pixels
+    SizeType        channels;       // How many samples per pixel
+    ImageSampleType sampleType;     // What kind of samples
+    unsigned int    maxValue;       // Value meaning "full intensity"
+                                    // (only for integer samples)
+    bool            bigEndian;      // Byte order of the samples
+    bool            bottomUp;       // Rows stored bottom-to-top?
+};
+
+
+class inca::io::ImageCodec {
+public:
     // Destructor
-    ~InvalidReferenceException() throw() { }
+    virtual ~ImageCodec() { }
 
-    // Accessors
-    const std::string & reference() const { return _reference; }
-    const std::string & id() const { return _id; }
+    // A short name for the format family (e.g., "PNM")
+    virtual std::string name() const = 0;
+
+    // Do these bytes (the beginning of a file) look like our format?
+    virtual bool recognizes(const char * magic, SizeType n) const = 0;
+
+    // The format we would actually write, if asked to write 'f', which may
+    // differ in its sample type or byte order. Throws an
+    // InvalidFileTypeException if 'f' can't be written in this format at all.
+    virtual ImageFormat writableFormat(const ImageFormat & f,
+                                       const std::string & file) const = 0;
+
+    // Read/write the header, leaving the stream at the first sample
+    virtual ImageFormat readHeader(std::istream & is, const std::string & file) const = 0;
+    virtual void writeHeader(std::ostream & os, const ImageFormat & f) const = 0;
+
+
+    // The shared instance of each codec
+    static const ImageCodec & pnm();
+    static const ImageCodec & pfm();
+    static const ImageCodec & raw();
+
+    // Pick a codec by file extension
+    static const ImageCodec & forFilename(const std::string & file);
+
+    // Pick a codec by looking at the beginning of the stream (which is
+    // restored to where it was)
+    static const ImageCodec & forStream(std::istream & is, const std::string & file);
 
 protected:
-    std::string _id, _reference;
+    // Read the next whitespace-separated token, skipping '#' comments
+    static std::string readToken(std::istream & is) {
+        std::string token;
+        int c = is.get();
+        while (is && (std::isspace(c) || c == '#')) {
+            if (c == '#')
+                while (is && c != '\n' && c != '\r')
+                    c = is.get();
+            c = is.get();
+        }
+        while (is && ! std::isspace(c) && c != '#') {
+            token += char(c);
+            c = is.get();
+        }
+        if (is)             // We consumed one char too many...
+            is.unget();
+        return token;
+    }
+
+    // Read an unsigned integer token
+    static SizeType readSize(std::istream & is, const std::string & file,
+                             const char * what) {
+        std::string token = readToken(is);
+        if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos)
+            formatError(file, std::string("invalid ") + what + " '" + token + "'");
+        return SizeType(std::strtoul(token.c_str(), NULL, 10));
+    }
+
+    // Consume the single whitespace character ending the header
+    static void endHeader(std::istream & is, const std::string & file) {
+        if (! std::isspace(is.get()) || ! is)
+            formatError(file, "missing end of header");
+    }
+
+    // Complain about a file that isn't what we expected, or is damaged
+    static void typeError(const std::string & file, const std::string & what) {
+        InvalidFileTypeException e(file);
+        e << "Image file \"" << file << "\": " << what;
+        throw e;
+    }
+    static void formatError(const std::string & file, const std::string & what) {
+        FileFormatException e(file);
+        e << "Image file \"" << file << "\" is damaged: " << what;
+        throw e;
+    }
 };
 
+
+class inca::io::PNMImageCodec : public ImageCodec {
+public:
+    std::string name() const { return "PNM"; }
+
+    bool recognizes(const char * magic, SizeType n) const {
+        return n >= 2 && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6');
+    }
+
+    ImageFormat writableFormat(const ImageFormat & f, const std::string & file) const {
+        if (f.channels != 1 && f.channels != 3)
+            typeError(file, "PGM/PPM images must have 1 or 3 channels");
+        ImageFormat w(f);
+        if (w.sampleType == Float32Samples) {
+            w.sampleType = UInt16Samples;
+            w.maxValue = 65535;
+        }
+        if (w.maxValue < 1 || w.maxValue > 65535
+                || (w.sampleType == UInt8Samples && w.maxValue > 255))
+            w.maxValue = (w.sampleType == UInt8Samples ? 255 : 65535);
+        w.bigEndian = true;             // Always, for 16-bit samples
+        w.bottomUp = false;
+        return w;
+    }
+
+    ImageFormat readHeader(std::istream & is, const std::string & file) const {
+        std::string magic = readToken(is);
+        if (magic != "P5" && magic != "P6")
+            typeError(file, "not a binary PGM/PPM file");
+        ImageFormat f;
+        f.channels = (magic == "P6" ? 3 : 1);
+        f.width    = readSize(is, file, "width");
+        f.height   = readSize(is, file, "height");
+        f.maxValue = (unsigned int)readSize(is, file, "maximum value");
+        if (f.maxValue < 1 || f.maxValue > 65535)
+            formatError(file, "maximum value out of range");
+        f.sampleType = (f.maxValue < 256 ? UInt8Samples : UInt16Samples);
+        f.bigEndian = true;
+        f.bottomUp = false;
+        endHeader(is, file);
+        return f;
+    }
+
+    void writeHeader(std::ostream & os, const ImageFormat & f) const {
+        os << (f.channels == 3 ? "P6" : "P5") << '\n'
+           << f.width << ' ' << f.height << '\n'
+           << f.maxValue << '\n';
+    }
+};
+
+
+class inca::io::PFMImageCodec : public ImageCodec {
+public:
+    std::string name() const { return "PFM"; }
+
+    bool recognizes(const char * magic, SizeType n) const {
+        return n >= 2 && magic[0] == 'P' && (magic[1] == 'f' || magic[1] == 'F');
+    }
+
+    ImageFormat writableFormat(const ImageFormat & f, const std::string & file) const {
+        if (f.channels != 1 && f.channels != 3)
+            typeError(file, "PFM images must have 1 or 3 channels");
+        ImageFormat w(f);
+        w.sampleType = Float32Samples;
+        w.maxValue = 1;
+        w.bottomUp = true;              // Always
+        return w;
+    }
+
+    ImageFormat readHeader(std::istream & is, const std::string & file) const {
+        std::string magic = readToken(is);
+        if (magic != "Pf" && magic != "PF")
+            typeError(file, "not a PFM file");
+        ImageFormat f;
+        f.channels = (magic == "PF" ? 3 : 1);
+        f.width    = readSize(is, file, "width");
+        f.height   = readSize(is, file, "height");
+        std::string scale = readToken(is);
+        char * end;
+        double s = std::strtod(scale.c_str(), &end);
+        if (scale.empty() || *end != '\0' || s == 0)
+            formatError(file, "invalid scale '" + scale + "'");
+        f.sampleType = Float32Samples;
+        f.maxValue = 1;
+        f.bigEndian = (s > 0);          // The sign of the scale says
+        f.bottomUp = true;
+        endHeader(is, file);
+        return f;
+    }
+
+    void writeHeader(std::ostream & os, const ImageFormat & f) const {
+        os << (f.channels == 3 ? "PF" : "Pf") << '\n'
+           << f.width << ' ' << f.height << '\n'
+           << (f.bigEndian ? "1.0" : "-1.0") << '\n';
+    }
+};
+
+
+class inca::io::RawImageCodec : public ImageCodec {
+public:
+    std::string name() const { return "raw"; }
+
+    bool recognizes(const char * magic, SizeType n) const {
+        return n >= 7 && std::memcmp(magic, "INCAIMG", 7) == 0;
+    }
+
+    ImageFormat writableFormat(const ImageFormat & f, const std::string & file) const {
+        if (f.channels < 1)
+            typeError(file, "images must have at least 1 channel");
+        ImageFormat w(f);
+        w.maxValue = (w.sampleType == UInt8Samples  ? 255
+                   :  w.sampleType == UInt16Samples ? 65535 : 1);
+        w.bottomUp = false;
+        return w;
+    }
+
+    ImageFormat readHeader(std::istream & is, const std::string & file) const {
+        if (readToken(is) != "INCAIMG")
+            typeError(file, "not a raw image file");
+        ImageFormat f;
+        f.width    = readSize(is, file, "width");
+        f.height   = readSize(is, file, "height");
+        f.channels = readSize(is, file, "channel count");
+        std::string type = readToken(is), order = readToken(is);
+        if      (type == "u8")  f.sampleType = UInt8Samples;
+        else if (type == "u16") f.sampleType = UInt16Samples;
+        else if (type == "f32") f.sampleType = Float32Samples;
+        else    formatError(file, "invalid sample type '" + type + "'");
+        if (order != "le" && order != "be")
+            formatError(file, "invalid byte order '" + order + "'");
+        if (f.channels < 1)
+            formatError(file, "no channels");
+        f.maxValue = (f.sampleType == UInt8Samples  ? 255
+                   :  f.sampleType == UInt16Samples ? 65535 : 1);
+        f.bigEndian = (order == "be");
+        f.bottomUp = false;
+        endHeader(is, file);
+        return f;
+    }
+
+    void writeHeader(std::ostream & os, const ImageFormat & f) const {
+        os << "INCAIMG\n"
+           << f.width << ' ' << f.height << ' ' << f.channels << ' '
+           << (f.sampleType == UInt8Samples  ? "u8"
+            :  f.sampleType == UInt16Samples ? "u16" : "f32") << ' '
+           << (f.bigEndian ? "be" : "le") << '\n';
+    }
+};
+
+
+// The shared instance of each codec
+inline const inca::io::ImageCodec & inca::io::ImageCodec::pnm() {
+    static const PNMImageCodec codec;
+    return codec;
+}
+inline const inca::io::ImageCodec & inca::io::ImageCodec::pfm() {
+    static const PFMImageCodec codec;
+    return codec;
+}
+inline const inca::io::ImageCodec & inca::io::ImageCodec::raw() {
+    static const RawImageCodec codec;
+    return codec;
+}
+
+// Pick a codec by file extension
+inline const inca::io::ImageCodec &
+inca::io::ImageCodec::forFilename(const std::string & file) {
+    std::string ext;
+    std::string::size_type dot = file.rfind('.');
+    if (dot != std::string::npos)
+        for (std::string::size_type i = dot + 1; i < file.size(); ++i)
+            ext += char(std::tolower(file[i]));
+
+    if (ext == "pgm" || ext == "ppm" || ext == "pnm")   return pnm();
+    if (ext == "pfm")                                   return pfm();
+    if (ext == "raw")                                   return raw();
+    typeError(file, "unknown image file extension '" + ext + "'");
+    return raw();   // Not reached
+}
+
+// Pick a codec by looking at the first few bytes of the stream
+inline const inca::io::ImageCodec &
+inca::io::ImageCodec::forStream(std::istream & is, const std::string & file) {
+    char magic[8];
+    std::istream::pos_type start = is.tellg();
+    is.read(magic, sizeof(magic));
+    SizeType n = SizeType(is.gcount());
+    is.clear();
+    is.seekg(start);
+
+    if (pnm().recognizes(magic, n))     return pnm();
+    if (pfm().recognizes(magic, n))     return pfm();
+    if (raw().recognizes(magic, n))     return raw();
+    typeError(file, "not in any known image format");
+    return raw();   // Not reached
+}
+
 #endif
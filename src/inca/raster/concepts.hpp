@@ -44,6 +44,16 @@
 #include <inca/util/metaprogramming/Nothing.hpp>
 #include <inca/util/metaprogramming/macros.hpp>
 
+
+// Span evaluation (see RasterAccessFacet) works through temporary buffers of
+// this many elements, which are allocated on the stack. This should be large
+// enough to amortize the per-span overhead, but small enough that the buffers
+// for a deeply nested operator expression stay in L1 cache.
+#ifndef INCA_RASTER_SPAN_BUFFER_SIZE
+#   define INCA_RASTER_SPAN_BUFFER_SIZE 256
+#endif
+
+
 // This is part of the Inca raster processing library
 namespace inca {
     namespace raster {
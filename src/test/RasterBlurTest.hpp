@@ -0,0 +1,277 @@
+/* -*- C++ -*-
+ *
+ * File: RasterBlurTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the blur operators and scale-space projection. The 3^N
+ *      blur, the recursive Gaussian blur and both kinds of scale-space are
+ *      checked against blurs computed by brute force, treating elements
+ *      beyond the edge as copies of the nearest edge element; in particular,
+ *      a constant image must stay constant all the way to its edges.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_BLUR
+#define TEST_RASTER_BLUR
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/blur>
+#include <inca/raster/algorithms/scale_space_project>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/fill>
+
+// Import containers & math functions
+#include <vector>
+#include <cmath>
+
+
+class RasterBlurTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterBlurTest                  ThisTest;
+    typedef MultiArrayRaster<float, 2>      R2;
+    typedef MultiArrayRaster<float, 3>      R3;
+    typedef R2::Region                      Region;
+    typedef R2::IndexArray                  IndexArray;
+    typedef R2::SizeArray                   SizeArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Blur tests
+        CPPUNIT_TEST(test_blur);
+        CPPUNIT_TEST(test_gaussian_blur);
+        CPPUNIT_TEST(test_gaussian_blur_threads);
+        CPPUNIT_TEST(test_scale_space);
+        CPPUNIT_TEST(test_constant_scale_space);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Blurs: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+        image = R2(Region(IndexArray(-3, 5), IndexArray(37, 33)));
+        unsigned int seed = 12345;
+        IndexArray idx(image.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            image(idx) = float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, image.bounds()));
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // 'idx', moved onto the nearest element of 'b'
+    static IndexArray clamped(IndexArray idx, const Region & b) {
+        for (IndexType d = 0; d < 2; ++d)
+            idx[d] = std::max(b.base(d), std::min(b.extent(d), idx[d]));
+        return idx;
+    }
+
+    // The separable blur of 'r' with the 1D kernel 'weights' (centered on
+    // its middle element), extending 'r' at its edges
+    static R2 naiveBlur(const R2 & r, const std::vector<double> & weights) {
+        IndexType radius = IndexType(weights.size() / 2);
+        R2 result(r.bounds());
+        IndexArray i(r.bases());
+        do {
+            double sum = 0.0;
+            for (IndexType dy = -radius; dy <= radius; ++dy)
+                for (IndexType dx = -radius; dx <= radius; ++dx)
+                    sum += weights[dx + radius] * weights[dy + radius]
+                         * r(clamped(IndexArray(i[0] + dx, i[1] + dy), r.bounds()));
+            result(i) = float(sum);
+        } while (nextIndex(i, r.bounds()));
+        return result;
+    }
+
+    // A sampled Gaussian, truncated at 'radius' and scaled to unit sum
+    static std::vector<double> gaussianWeights(double sigma, IndexType radius) {
+        std::vector<double> w(2 * radius + 1);
+        double total = 0.0;
+        for (IndexType k = -radius; k <= radius; ++k)
+            total += w[k + radius] = std::exp(-0.5 * k * k / (sigma * sigma));
+        for (SizeType k = 0; k < w.size(); ++k)
+            w[k] /= total;
+        return w;
+    }
+
+    // The largest difference between 'expected' and 'r', whether read one
+    // element at a time or a span at a time
+    template <class R>
+    static double difference(const R2 & expected, const R & r) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return 1e10;
+        R2 spans(r.bounds());
+        copy(spans, r);
+        double worst = 0.0;
+        IndexArray idx(expected.bases());
+        do {
+            worst = std::max(worst, double(std::abs(expected(idx) - float(r(idx)))));
+            worst = std::max(worst, double(std::abs(expected(idx) - spans(idx))));
+        } while (nextIndex(idx, expected.bounds()));
+        return worst;
+    }
+
+    // A copy of 'r', moved to the origin (as scale-spaces are)
+    static R2 atOrigin(const R2 & r) {
+        R2 result(SizeArray(r.sizes()));
+        IndexArray idx(r.bases());
+        do {
+            result(IndexArray(idx[0] - r.base(0), idx[1] - r.base(1))) = r(idx);
+        } while (nextIndex(idx, r.bounds()));
+        return result;
+    }
+
+    // Layer 's' of the scale-space 'r'
+    static R2 layer(const R3 & r, IndexType s) {
+        R2 result(Region(IndexArray(r.base(0), r.base(1)), IndexArray(r.extent(0), r.extent(1))));
+        IndexArray idx(result.bases());
+        do {
+            result(idx) = r(R3::IndexArray(idx[0], idx[1], s));
+        } while (nextIndex(idx, result.bounds()));
+        return result;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Blur tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_blur() {
+        std::vector<double> binomial(3);
+        binomial[0] = 0.25;  binomial[1] = 0.5;  binomial[2] = 0.25;
+        CPPUNIT_ASSERT(difference(naiveBlur(image, binomial), blur(image)) < 1e-5);
+        R2 once = naiveBlur(image, binomial);
+        CPPUNIT_ASSERT(difference(naiveBlur(once, binomial), blur(blur(image))) < 1e-5);
+        cerr << '.';
+    }
+
+    // The recursive filter only approximates the Gaussian, but closely
+    // (for sigma of a couple of elements or more)
+    void test_gaussian_blur() {
+        float sigmas[] = { 2.0f, 4.0f, 7.5f };
+        for (int s = 0; s < 3; ++s) {
+            std::vector<double> w = gaussianWeights(sigmas[s], IndexType(5 * sigmas[s]) + 1);
+            CPPUNIT_ASSERT(difference(naiveBlur(image, w), gaussianBlur(image, sigmas[s])) < 0.02);
+        }
+
+        // Too narrow to blur at all
+        CPPUNIT_ASSERT(difference(image, gaussianBlur(image, 0.3f)) == 0.0);
+
+        // A constant stays constant, even at the edges (up to the rounding
+        // error of a long-lived feedback loop, for very wide Gaussians)
+        R2 flat(image.bounds()), expected(image.bounds());
+        fill(flat, 0.75f);
+        fill(expected, 0.75f);
+        float widths[] = { 0.6f, 1.0f, 3.0f, 20.0f };
+        for (int s = 0; s < 4; ++s)
+            CPPUNIT_ASSERT(difference(expected, gaussianBlur(flat, widths[s])) < 1e-3);
+        cerr << '.';
+    }
+
+    void test_gaussian_blur_threads() {
+        setEvaluationTileSize(64);
+        R2 serial(image.bounds());
+        copy(serial, gaussianBlur(image, 2.5f));
+        setEvaluationThreadCount(4);
+        CPPUNIT_ASSERT(difference(serial, gaussianBlur(image, 2.5f)) == 0.0);
+        cerr << '.';
+    }
+
+    // Both filters blur with a unit-sum Gaussian and extend the image at
+    // its edges, so they must agree (as far as the recursive approximation
+    // does with a true Gaussian, which isn't far for sigma >= 2)
+    void test_scale_space() {
+        std::vector<float> scales;
+        scales.push_back(0.0f);
+        scales.push_back(1.0f);
+        scales.push_back(4.0f);
+        scales.push_back(9.0f);
+
+        R2 source = atOrigin(image);
+        R3 fourier, recursive;
+        scale_space_project(fourier, source, scales);
+        scale_space_project(recursive, source, scales, RecursiveScaleSpace);
+        CPPUNIT_ASSERT(fourier.size(2) == 4 && recursive.size(2) == 4);
+
+        for (IndexType s = 0; s < 4; ++s) {
+            R2 f = layer(fourier, s), r = layer(recursive, s);
+            if (scales[s] == 0.0f) {
+                CPPUNIT_ASSERT(difference(source, f) == 0.0);
+                CPPUNIT_ASSERT(difference(source, r) < 1e-6);
+            } else {
+                double sigma = std::sqrt(scales[s]);
+                R2 expected = naiveBlur(source, gaussianWeights(sigma, gaussianRadius(sigma)));
+                CPPUNIT_ASSERT(difference(expected, f) < 1e-4);
+                if (sigma >= 2.0)
+                    CPPUNIT_ASSERT(difference(expected, r) < 0.02);
+            }
+        }
+        cerr << '.';
+    }
+
+    void test_constant_scale_space() {
+        std::vector<float> scales;
+        scales.push_back(2.0f);
+        scales.push_back(16.0f);
+        R2 flat(SizeArray(image.sizes())), expected(SizeArray(image.sizes()));
+        fill(flat, -2.5f);
+        fill(expected, -2.5f);
+
+        R3 fourier, recursive;
+        scale_space_project(fourier, flat, scales);
+        scale_space_project(recursive, flat, scales, RecursiveScaleSpace);
+        for (IndexType s = 0; s < 2; ++s) {
+            R2 f = layer(fourier, s), r = layer(recursive, s);
+            CPPUNIT_ASSERT(difference(expected, f) < 1e-4);
+            CPPUNIT_ASSERT(difference(expected, r) < 1e-4);
+        }
+        cerr << '.';
+    }
+
+protected:
+    R2          image;      // Random values in [0, 1), based away from zero
+    SizeType    tileSize;   // The evaluation tile size before the test
+};
+
+#endif
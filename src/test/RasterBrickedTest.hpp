@@ -0,0 +1,251 @@
+/* -*- C++ -*-
+ *
+ * File: RasterBrickedTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for bricked storage. A BrickedMultiArrayRaster must hold exactly
+ *      what a MultiArrayRaster copied from the same source holds, whether
+ *      read an element or a span at a time, in and around its bounds, with
+ *      sizes that leave the last bricks partly empty and bounds based away
+ *      from zero; spans written into it must land in the same places.
+ *      Operators must not be able to tell the two apart, and walking it in
+ *      memory order must visit every element exactly once.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_BRICKED
+#define TEST_RASTER_BRICKED
+
+
+using namespace inca::raster;
+
+
+// Import the container under test
+#include <inca/raster/BrickedMultiArrayRaster>
+#include <inca/raster/MultiArrayRaster>
+
+// Import operators & algorithms to run over it
+#include <inca/raster/operators/derivative>
+#include <inca/raster/operators/blur>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/fill>
+
+// Import containers
+#include <vector>
+
+
+class RasterBrickedTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterBrickedTest                       ThisTest;
+    typedef MultiArrayRaster<float, 2>              R2;
+    typedef MultiArrayRaster<float, 3>              R3;
+    typedef BrickedMultiArrayRaster<float, 2>       B2;         // 16x16 bricks
+    typedef BrickedMultiArrayRaster<float, 2, 2>    Small2;     // 4x4 bricks
+    typedef BrickedMultiArrayRaster<float, 3, 2>    Small3;     // 4x4x4 bricks
+    typedef R2::Region                              Region;
+    typedef R2::IndexArray                          IndexArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Bricked raster tests
+        CPPUNIT_TEST(test_elements_2d);
+        CPPUNIT_TEST(test_elements_3d);
+        CPPUNIT_TEST(test_set_span);
+        CPPUNIT_TEST(test_operators);
+        CPPUNIT_TEST(test_bounds);
+        CPPUNIT_TEST(test_memory_order);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Bricked Storage: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        seed = 12345;
+        image = R2(Region(IndexArray(-5, 3), IndexArray(31, 23)));     // 37x21
+        scramble(image);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [0, 1) with no particular structure, the same every time
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // Do 'r' and 'expected' agree exactly, reading elements one at a time
+    // (in and around their bounds), and reading runs of several lengths from
+    // every starting point along each row? Runs cross brick boundaries in
+    // every possible phase, and reach beyond the bounds at either end.
+    // (Fused stencils read element-wise and span-wise may differ in the last
+    // bit, so spans are compared with spans.)
+    template <class R, class E>
+    static bool same(const R & r, const E & expected) {
+        typedef typename R::IndexArray IndexArray;
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+
+        SizeType lengths[] = { 1, 3, 17, r.size(0) + 6 };
+        std::vector<float> buffer, expectedBuffer;
+        typename R::Region around(r.bounds());
+        IndexArray lo(r.bases()), hi(r.extents());
+        for (IndexType d = 0; d < IndexType(R::dimensionality); ++d) {
+            lo[d] -= 2;
+            hi[d] += 2;
+        }
+        around.setBasesAndExtents(lo, hi);
+
+        IndexArray idx(around.bases());
+        do {
+            if (float(r(idx)) != float(expected(idx)))
+                return false;
+            for (int l = 0; l < 4; ++l) {
+                buffer.resize(lengths[l]);
+                expectedBuffer.resize(lengths[l]);
+                r.span(idx, lengths[l], &buffer[0]);
+                expected.span(idx, lengths[l], &expectedBuffer[0]);
+                if (buffer != expectedBuffer)
+                    return false;
+            }
+        } while (nextIndex(idx, around));
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Bricked raster tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Large bricks (a partial brick at the far end of each axis) and small
+    // ones (many bricks along each row)
+    void test_elements_2d() {
+        B2 big(image);
+        Small2 small(image);
+        CPPUNIT_ASSERT(big.array().brickCount() == 6);
+        CPPUNIT_ASSERT(small.array().brickCount() == 60);
+        CPPUNIT_ASSERT(same(big, image));
+        CPPUNIT_ASSERT(same(small, image));
+        cerr << '.';
+    }
+
+    void test_elements_3d() {
+        R3 volume(R3::Region(R3::IndexArray(2, -7, 1), R3::IndexArray(12, -2, 9)));
+        scramble(volume);
+        Small3 bricked(volume);
+        CPPUNIT_ASSERT(bricked.array().brickCount() == 3 * 2 * 3);
+        CPPUNIT_ASSERT(same(bricked, volume));
+        cerr << '.';
+    }
+
+    // Whole rows, and runs starting and ending mid-brick, written as spans
+    void test_set_span() {
+        Small2 bricked(image.bounds());
+        R2 expected(image.bounds());
+        copy(bricked, image);
+        CPPUNIT_ASSERT(same(bricked, image));
+
+        std::vector<float> values(13);
+        for (SizeType i = 0; i < SizeType(values.size()); ++i)
+            values[i] = -float(i);
+        copy(expected, image);
+        for (IndexType y = image.base(1); y <= image.extent(1); y += 3) {
+            IndexArray start(image.base(0) + 3 + y % 5, y);
+            bricked.storeSpan(start, SizeType(values.size()), &values[0]);
+            expected.storeSpan(start, SizeType(values.size()), &values[0]);
+        }
+        CPPUNIT_ASSERT(same(bricked, expected));
+        cerr << '.';
+    }
+
+    // Neighborhood operators read it (and beyond its edges) the same way
+    void test_operators() {
+        Small2 bricked(image);
+        CPPUNIT_ASSERT(same(d(bricked, 0), d(image, 0)));
+        CPPUNIT_ASSERT(same(d(bricked, 1), d(image, 1)));
+        CPPUNIT_ASSERT(same(blur(bricked), blur(image)));
+        CPPUNIT_ASSERT(same(d(blur(bricked), 1), d(blur(image), 1)));
+        cerr << '.';
+    }
+
+    // Moving it keeps its size and elements; resizing it throws them away
+    void test_bounds() {
+        Small2 bricked(image);
+        bricked.setBases(IndexArray(7, -11));
+        CPPUNIT_ASSERT(bricked.bases() == IndexArray(7, -11));
+        R2 moved(bricked.bounds());
+        IndexArray idx(image.bases());
+        do {
+            moved(idx[0] + 12, idx[1] - 14) = image(idx);
+        } while (nextIndex(idx, image.bounds()));
+        CPPUNIT_ASSERT(same(bricked, moved));
+
+        bricked.setBounds(Region(IndexArray(1, 1), IndexArray(5, 18)));
+        CPPUNIT_ASSERT(bricked.sizes() == R2::SizeArray(5, 18));
+        R2 small(bricked.bounds());
+        scramble(small);
+        copy(bricked, small);
+        CPPUNIT_ASSERT(same(bricked, small));
+        cerr << '.';
+    }
+
+    void test_memory_order() {
+        Small2 bricked(image);
+        MultiArrayRaster<int, 2> visits(image.bounds());
+        fill(visits, 0);
+        SizeType count = 0;
+        Small2::MultiArrayType::ConstIterator it = bricked.array().begin();
+        for (; it != bricked.array().end(); ++it, ++count) {
+            IndexArray idx = it.indices();
+            CPPUNIT_ASSERT(image.bounds().contains(idx));
+            CPPUNIT_ASSERT(*it == image(idx));
+            ++visits(idx);
+        }
+        CPPUNIT_ASSERT(count == image.size());
+        IndexArray idx(image.bases());
+        do {
+            CPPUNIT_ASSERT(visits(idx) == 1);
+        } while (nextIndex(idx, image.bounds()));
+        cerr << '.';
+    }
+
+protected:
+    R2              image;      // Some values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+};
+
+#endif
@@ -0,0 +1,193 @@
+/* -*- C++ -*-
+ *
+ * File: RasterCacheTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the memoizing operator. Operators reading a cached raster
+ *      must get exactly what they would get from the raster itself, inside
+ *      and outside of its bounds, whether reading elements or spans; spans
+ *      reaching beyond the cached region (even when asked of the cache's
+ *      core directly) must be passed through to the operand. Tiles must be
+ *      evaluated only when first read.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_CACHE
+#define TEST_RASTER_CACHE
+
+
+using namespace inca::raster;
+
+
+// Import the operators under test
+#include <inca/raster/operators/cache>
+#include <inca/raster/operators/derivative>
+#include <inca/raster/operators/blur>
+
+// Import containers
+#include <vector>
+
+
+class RasterCacheTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterCacheTest                 ThisTest;
+    typedef MultiArrayRaster<float, 2>      R2;
+    typedef R2::Region                      Region;
+    typedef R2::IndexArray                  IndexArray;
+
+    // A cache whose core may be asked for spans directly, bypassing the
+    // bounds-clipping done by span()
+    class ExposedCache : public CachedOperatorRaster<R2> {
+    public:
+        ExposedCache(const R2 & r, SizeType tileSize)
+            : CachedOperatorRaster<R2>(r, tileSize) { }
+
+        void coreSpan(const IndexArray & idx, SizeType count, float * out) const {
+            this->getSpan(idx, count, out);
+        }
+    };
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Cache tests
+        CPPUNIT_TEST(test_cached_operands);
+        CPPUNIT_TEST(test_out_of_bounds_spans);
+        CPPUNIT_TEST(test_lazy_tiles);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Cache: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        source = R2(Region(IndexArray(-4, 3), IndexArray(40, 29)));
+        source.setOutOfBoundsPolicy(Nearest);
+        unsigned int seed = 12345;
+        IndexArray idx(source.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            source(idx) = float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, source.bounds()));
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Do 'r' and 'expected' agree exactly, reading elements one at a time,
+    // and reading runs starting before, within and after their bounds, on
+    // rows within and outside of them?
+    template <class R, class E>
+    static bool same(const R & r, const E & expected) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+        SizeType lengths[] = { 1, 7, r.size(0) + 6 };
+        std::vector<float> buffer;
+        IndexArray idx;
+        for (idx[1] = r.base(1) - 2; idx[1] <= r.extent(1) + 2; ++idx[1])
+            for (IndexType start = r.base(0) - 3; start <= r.extent(0) + 3; ++start) {
+                idx[0] = start;
+                if (float(r(idx)) != float(expected(idx)))
+                    return false;
+                for (int l = 0; l < 3; ++l) {
+                    buffer.resize(lengths[l]);
+                    r.span(idx, lengths[l], &buffer[0]);
+                    for (SizeType i = 0; i < lengths[l]; ++i)
+                        if (buffer[i] != float(expected(IndexArray(start + IndexType(i), idx[1]))))
+                            return false;
+                }
+            }
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Cache tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Neighborhood operators read the cache beyond its edges
+    void test_cached_operands() {
+        CPPUNIT_ASSERT(same(d(cache(source, 50), 1), d(source, 1)));
+        CPPUNIT_ASSERT(same(d(cache(source, 50), 0), d(source, 0)));
+        CPPUNIT_ASSERT(same(blur(cache(source, 50)), blur(source)));
+        CPPUNIT_ASSERT(same(blur(materialize(source)), blur(source)));
+        CPPUNIT_ASSERT(same(cache(d(source, 1), 50), d(source, 1)));
+        cerr << '.';
+    }
+
+    // Whatever the core is asked for, only the cached part of the run comes
+    // from the tiles
+    void test_out_of_bounds_spans() {
+        ExposedCache c(source, 50);
+        SizeType lengths[] = { 1, 4, source.size(0) + 9 };
+        std::vector<float> buffer;
+        IndexArray idx;
+        for (idx[1] = source.base(1) - 2; idx[1] <= source.extent(1) + 2; ++idx[1])
+            for (IndexType start = source.base(0) - 5; start <= source.extent(0) + 5; ++start)
+                for (int l = 0; l < 3; ++l) {
+                    buffer.resize(lengths[l]);
+                    idx[0] = start;
+                    c.coreSpan(idx, lengths[l], &buffer[0]);
+                    for (SizeType i = 0; i < lengths[l]; ++i)
+                        CPPUNIT_ASSERT(buffer[i] == source(start + IndexType(i), idx[1]));
+                }
+        CPPUNIT_ASSERT(c.tilesEvaluated() == c.tileCount());
+        cerr << '.';
+    }
+
+    void test_lazy_tiles() {
+        CachedOperatorRaster<R2> c = cache(source, 50);
+        CPPUNIT_ASSERT(c.tileCount() > 1);
+        CPPUNIT_ASSERT(c.tilesEvaluated() == 0);
+
+        // Out-of-bounds reads don't touch the cache
+        float buffer[5];
+        c.span(IndexArray(source.base(0) - 8, source.base(1)), 5, buffer);
+        c(source.base(0), source.base(1) - 1);
+        CPPUNIT_ASSERT(c.tilesEvaluated() == 0);
+
+        CPPUNIT_ASSERT(c(source.bases()) == source(source.bases()));
+        CPPUNIT_ASSERT(c.tilesEvaluated() == 1);
+        c.span(IndexArray(source.base(0) - 2, source.base(1)), 3, buffer);
+        CPPUNIT_ASSERT(c.tilesEvaluated() == 1);
+
+        c.invalidate();
+        CPPUNIT_ASSERT(c.tilesEvaluated() == 0);
+        CPPUNIT_ASSERT(same(c, source));
+        CPPUNIT_ASSERT(c.tilesEvaluated() == c.tileCount());
+        cerr << '.';
+    }
+
+protected:
+    R2 source;      // Random values in [0, 1), based away from zero
+};
+
+#endif
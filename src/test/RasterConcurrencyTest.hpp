@@ -0,0 +1,184 @@
+/* -*- C++ -*-
+ *
+ * File: RasterConcurrencyTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Stress test for the reentrancy of raster operators. The same
+ *      operator trees are evaluated serially and from many threads at once
+ *      (both through the tiled evaluation engine, and by threads reading
+ *      every element of a single, shared tree, including out-of-bounds
+ *      elements), and the results must match exactly.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_CONCURRENCY
+#define TEST_RASTER_CONCURRENCY
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/arithmetic>
+#include <inca/raster/operators/derivative>
+#include <inca/raster/operators/blur>
+#include <inca/raster/operators/resample>
+#include <inca/raster/operators/cache>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/parallel>
+
+// Import threading primitives
+#include <thread>
+#include <vector>
+
+
+class RasterConcurrencyTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterConcurrencyTest ThisTest;
+    typedef MultiArrayRaster<float, 2>  R2;
+    typedef R2::IndexArray              IndexArray;
+
+    // How hard do we push?
+    static const int threadCount = 16;
+    static const int rounds      = 4;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Concurrency tests
+        CPPUNIT_TEST(test_parallel_evaluation);
+        CPPUNIT_TEST(test_shared_element_reads);
+        CPPUNIT_TEST(test_shared_cache);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Concurrency: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        source = R2(R2::SizeArray(97, 61));
+        for (IndexType j = 0; j < 61; ++j)
+            for (IndexType i = 0; i < 97; ++i)
+                source(i, j) = float((i * 31 + j * 17) % 23) - 0.25f * float(j % 7);
+        source.setOutOfBoundsPolicy(Constant);
+        source.setOutOfBoundsValue(-1.0f);
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Read every element of 'r' (plus a border of out-of-bounds elements)
+    // one at a time, in row order
+    template <class R>
+    static std::vector<float> readAll(const R & r) {
+        std::vector<float> values;
+        IndexArray idx;
+        for (idx[1] = r.base(1) - 2; idx[1] <= r.extent(1) + 2; ++idx[1])
+            for (idx[0] = r.base(0) - 2; idx[0] <= r.extent(0) + 2; ++idx[0])
+                values.push_back(float(r(idx)));
+        return values;
+    }
+
+    // Read 'r' from many threads at once, checking each against 'expected'
+    template <class R>
+    static void readConcurrently(const R & r, const std::vector<float> & expected) {
+        for (int round = 0; round < rounds; ++round) {
+            std::vector< std::vector<float> > results(threadCount);
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threadCount; ++t)
+                pool.push_back(std::thread([&, t]() { results[t] = readAll(r); }));
+            for (int t = 0; t < threadCount; ++t)
+                pool[t].join();
+            for (int t = 0; t < threadCount; ++t)
+                CPPUNIT_ASSERT(results[t] == expected);
+        }
+        cerr << '.';
+    }
+
+    // Evaluate 'r' into memory with 'threads' evaluation threads
+    template <class R>
+    static R2 evaluate(const R & r, SizeType threads) {
+        setEvaluationThreadCount(threads);
+        R2 result(r.bounds());
+        parallel_copy(result, r);
+        setEvaluationThreadCount(1);
+        return result;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Concurrency tests
+ *---------------------------------------------------------------------------*/
+public:
+    // A deep expression evaluated by the tiled engine must match serial
+    void test_parallel_evaluation() {
+        Array<float, 2> scale(0.5f, 1.7f);
+        R2 serial = evaluate(resample(blur(d(source, 0)) * 2.0f + source, scale), 1);
+        for (int round = 0; round < rounds; ++round) {
+            R2 parallel = evaluate(resample(blur(d(source, 0)) * 2.0f + source, scale),
+                                   threadCount);
+            CPPUNIT_ASSERT(readAll(parallel) == readAll(serial));
+        }
+        cerr << '.';
+    }
+
+    // Many threads reading elements of the same operators must not race
+    void test_shared_element_reads() {
+        Array<float, 2> minify(0.34f, 0.5f), magnify(2.5f, 1.5f);
+        readConcurrently(source, readAll(source));
+
+        ResampleOperatorRaster<R2> small(source, minify), big(source, magnify);
+        readConcurrently(small, readAll(small));
+        readConcurrently(big, readAll(big));
+
+        typedef DerivativeOperatorRaster<R2> D;
+        typedef DerivativeOperatorRaster<D>  DD;
+        DD dd(D(source, 0), 1);
+        readConcurrently(dd, readAll(dd));
+        readConcurrently(d(d(source, 0), 1), readAll(dd));
+    }
+
+    // Many threads filling the same cache must each see the serial result
+    void test_shared_cache() {
+        std::vector<float> expected = readAll(blur(d(source, 1)));
+        for (int round = 0; round < rounds; ++round)
+            readConcurrently(cache(blur(d(source, 1)), 256), expected);
+    }
+
+protected:
+    R2 source;      // The raster we torture
+};
+
+#endif
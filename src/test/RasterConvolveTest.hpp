@@ -0,0 +1,258 @@
+/* -*- C++ -*-
+ *
+ * File: RasterConvolveTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the convolution operator. Direct and Fourier convolution
+ *      are both checked against a convolution computed by brute force, with
+ *      kernels centered on their origins and kernels lying entirely to one
+ *      side of it (which the Fourier padding must also account for), and
+ *      with the image extended by each out-of-bounds policy. Kernel spectra
+ *      must be cached and reused across images of the same size.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_CONVOLVE
+#define TEST_RASTER_CONVOLVE
+
+
+using namespace inca::raster;
+
+
+// Import the operators under test
+#include <inca/raster/operators/convolve>
+#include <inca/raster/algorithms/copy>
+
+// Import math functions
+#include <cmath>
+
+
+class RasterConvolveTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterConvolveTest                      ThisTest;
+    typedef MultiArrayRaster<float, 2>              R2;
+    typedef R2::Region                              Region;
+    typedef R2::IndexArray                          IndexArray;
+    typedef R2::SizeArray                           SizeArray;
+    typedef ConvolutionSpectrumCache<float, 2>      SpectrumCache;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Convolution tests
+        CPPUNIT_TEST(test_centered_kernel);
+        CPPUNIT_TEST(test_off_origin_kernels);
+        CPPUNIT_TEST(test_spectrum_cache);
+        CPPUNIT_TEST(test_boundary_policies);
+        CPPUNIT_TEST(test_reach_too_large);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Convolution: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        seed = 12345;
+        image = R2(Region(IndexArray(-4, 3), IndexArray(18, 19)));
+        scramble(image);
+    }
+
+    void tearDown() {
+        SpectrumCache::instance().setCapacity(32);
+        SpectrumCache::instance().clear();
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [-1, 1) with no particular structure, the same every time
+    void scramble(R2 & r) {
+        IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = float((seed >> 16) % 2000) / 1000.0f - 1.0f;
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // A kernel with the given bounds, full of random weights
+    R2 kernel(const IndexArray & bases, const IndexArray & extents) {
+        Region b;
+        b.setBasesAndExtents(bases, extents);
+        R2 k(b);
+        scramble(k);
+        return k;
+    }
+
+    // The convolution of 'r' with 'k', computed by brute force, treating
+    // the outside of 'r' as zero (or, if 'extend', according to its
+    // out-of-bounds policy)
+    static R2 naiveConvolution(const R2 & r, const R2 & k, bool extend = false) {
+        R2 result(r.bounds());
+        IndexArray i(r.bases());
+        do {
+            double sum = 0.0;
+            IndexArray j(k.bases());
+            do {
+                IndexArray src(i[0] - j[0], i[1] - j[1]);
+                if (extend || r.bounds().contains(src))
+                    sum += double(r(src)) * double(k(j));
+            } while (nextIndex(j, k.bounds()));
+            result(i) = float(sum);
+        } while (nextIndex(i, r.bounds()));
+        return result;
+    }
+
+    // Does 'r' have the bounds of 'expected', and elements within 'epsilon',
+    // whether read one at a time or a span at a time?
+    template <class R>
+    static bool near(const R2 & expected, const R & r, double epsilon) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+        R2 spans(r.bounds());
+        copy(spans, r);
+        IndexArray idx(expected.bases());
+        do {
+            if (std::abs(expected(idx) - float(r(idx))) > epsilon
+                    || std::abs(expected(idx) - spans(idx)) > epsilon)
+                return false;
+        } while (nextIndex(idx, expected.bounds()));
+        return true;
+    }
+
+    // Do both methods of convolving 'image' with 'k' get the right answer?
+    bool convolvesCorrectly(const R2 & k) {
+        R2 expected = naiveConvolution(image, k);
+        ConvolutionOperatorRaster<R2> direct  = convolve(image, k, DirectConvolution),
+                                      fourier = convolve(image, k, FourierConvolution);
+        return direct.method() == DirectConvolution
+            && fourier.method() == FourierConvolution
+            && near(expected, direct, 1e-4)
+            && near(expected, fourier, 1e-3);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Convolution tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_centered_kernel() {
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(-2, -3), IndexArray(2, 3))));
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(0, 0), IndexArray(0, 0))));
+        cerr << '.';
+    }
+
+    // Kernels that shift the image, which wraps around further than their
+    // sizes alone would suggest
+    void test_off_origin_kernels() {
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(5, 5), IndexArray(9, 9))));
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(-9, -9), IndexArray(-5, -5))));
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(-2, 3), IndexArray(6, 4))));
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(-15, 2), IndexArray(-13, 17))));
+
+        // Shifted clean off of the image
+        CPPUNIT_ASSERT(convolvesCorrectly(kernel(IndexArray(30, 0), IndexArray(31, 1))));
+        cerr << '.';
+    }
+
+    // Each kernel is transformed once per padded size, no matter how many
+    // images it is used with (or whether it is rebuilt from scratch)
+    void test_spectrum_cache() {
+        SpectrumCache & cache = SpectrumCache::instance();
+        cache.clear();
+
+        R2 k = kernel(IndexArray(-1, 2), IndexArray(3, 6));
+        R2 other(image.bounds());
+        scramble(other);
+        FourierConvolver<float, 2> a(image, SizeArray(6)), b(other, SizeArray(6));
+        CPPUNIT_ASSERT(a.paddedSizes() == b.paddedSizes());
+
+        R2 result;
+        a.convolve(result, k);
+        CPPUNIT_ASSERT(cache.size() == 1);
+        CPPUNIT_ASSERT(near(naiveConvolution(image, k), result, 1e-3));
+
+        R2 copyOfK(k.bounds());
+        copy(copyOfK, k);
+        b.convolve(result, copyOfK);
+        CPPUNIT_ASSERT(cache.size() == 1);
+        CPPUNIT_ASSERT(near(naiveConvolution(other, k), result, 1e-3));
+
+        // A different kernel of the same shape is a different spectrum
+        R2 k2 = kernel(IndexArray(-1, 2), IndexArray(3, 6));
+        a.convolve(result, k2);
+        CPPUNIT_ASSERT(cache.size() == 2);
+        CPPUNIT_ASSERT(near(naiveConvolution(image, k2), result, 1e-3));
+
+        // Evicting it makes no difference to the answer
+        cache.setCapacity(1);
+        CPPUNIT_ASSERT(cache.size() == 1);
+        b.convolve(result, k2);
+        a.convolve(result, k);
+        CPPUNIT_ASSERT(cache.size() == 1);
+        CPPUNIT_ASSERT(near(naiveConvolution(image, k), result, 1e-3));
+        cerr << '.';
+    }
+
+    // The image may also be extended beyond its edges
+    void test_boundary_policies() {
+        OutOfBoundsPolicy policies[] = { Nearest, Mirror, Wrap };
+        R2 k = kernel(IndexArray(-4, -1), IndexArray(2, 6));
+        for (int p = 0; p < 3; ++p) {
+            FourierConvolver<float, 2> c(image, SizeArray(6), policies[p]);
+            R2 result;
+            c.convolve(result, k);
+            image.setOutOfBoundsPolicy(policies[p]);
+            CPPUNIT_ASSERT(near(naiveConvolution(image, k, true), result, 1e-3));
+        }
+        cerr << '.';
+    }
+
+    void test_reach_too_large() {
+        FourierConvolver<float, 2> c(image, SizeArray(3, 8));
+        R2 result;
+        bool threw = false;
+        try {
+            c.convolve(result, kernel(IndexArray(4, 0), IndexArray(5, 1)));
+        } catch (OutOfBoundsException &) {
+            threw = true;
+        }
+        CPPUNIT_ASSERT(threw);
+
+        c.convolve(result, kernel(IndexArray(-3, -8), IndexArray(3, 8)));
+        cerr << '.';
+    }
+
+protected:
+    R2              image;      // Some values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+};
+
+#endif
@@ -0,0 +1,342 @@
+/* -*- C++ -*-
+ *
+ * File: RasterFlatTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for flat traversal. Filling and copying MultiArrays and their
+ *      slices (which walk memory with raw pointers, in one sweep when the
+ *      elements are contiguous and a row at a time when they are not) must
+ *      touch exactly the elements that an element-by-element loop would,
+ *      in either storage order. Likewise for the raster fill(), copy() and
+ *      apply() algorithms, which read and store a span at a time, including
+ *      spans stored partly out of bounds and views with strided rows.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_FLAT
+#define TEST_RASTER_FLAT
+
+
+using namespace inca::raster;
+
+
+// Import the containers & algorithms under test
+#include <inca/util/MultiArray>
+#include <inca/raster/MultiArrayViewRaster>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/fill>
+#include <inca/raster/algorithms/apply>
+
+// Import containers & standard algorithms
+#include <vector>
+#include <algorithm>
+
+
+class RasterFlatTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterFlatTest                          ThisTest;
+    typedef inca::MultiArray<int, 3>                A3;
+    typedef A3::SliceView                           Slice;
+    typedef A3::IndexArray                          IndexArray3;
+    typedef A3::SizeArray                           SizeArray3;
+    typedef A3::StorageOrder                        StorageOrder;
+    typedef MultiArrayRaster<float, 2>              R2;
+    typedef MultiArrayViewRaster<int, 2>            View2;
+    typedef R2::Region                              Region;
+    typedef R2::IndexArray                          IndexArray;
+
+    // Adds up what it is shown, and how many things it was shown
+    struct Sum {
+        Sum() : total(0.0), count(0) { }
+        void operator()(float x) { total += x; ++count; }
+        double      total;
+        SizeType    count;
+    };
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Flat traversal tests
+        CPPUNIT_TEST(test_contiguity);
+        CPPUNIT_TEST(test_linear_order);
+        CPPUNIT_TEST(test_fill);
+        CPPUNIT_TEST(test_copy);
+        CPPUNIT_TEST(test_raster_algorithms);
+        CPPUNIT_TEST(test_store_span);
+        CPPUNIT_TEST(test_strided_rows);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Flat Traversal: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        seed = 12345;
+        image = R2(Region(IndexArray(-5, 3), IndexArray(31, 23)));
+        scramble(image);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [0, 1000) with no particular structure, the same
+    // every time
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = typename R::ElementType((seed >> 16) % 1000);
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // A 7x5x4 array, based away from zero, in which every element is
+    // different (and says where it is)
+    static A3 numbered(const StorageOrder & so) {
+        A3 a(A3::Region(IndexArray3(-2, 3, 1), IndexArray3(4, 7, 4)), so);
+        IndexArray3 idx(a.bases());
+        do {
+            a(idx) = code(idx);
+        } while (nextIndex(idx, a.bounds()));
+        return a;
+    }
+    static int code(const IndexArray3 & idx) {
+        return 1 + (idx[0] + 10) + 100 * (idx[1] + 10) + 10000 * (idx[2] + 10);
+    }
+
+    // Fill slice 'i' along 'd' with 'value', and check that this changed
+    // exactly those elements of 'a'
+    static bool fillsSlice(A3 a, IndexType d, IndexType i, int value) {
+        Slice s = a.slice(d, i);
+        s.fill(value);
+        IndexArray3 idx(a.bases());
+        do {
+            if (a(idx) != (idx[d] == i ? value : code(idx)))
+                return false;
+        } while (nextIndex(idx, a.bounds()));
+        return true;
+    }
+
+    // Do 'r' and 'expected' have the same bounds and elements?
+    template <class R, class E>
+    static bool same(const R & r, const E & expected) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+        typename R::IndexArray idx(r.bases());
+        do {
+            if (r(idx) != expected(idx))
+                return false;
+        } while (nextIndex(idx, r.bounds()));
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Flat traversal tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Whole arrays, and slices along their slowest-varying dimension, are
+    // contiguous; other slices are not
+    void test_contiguity() {
+        A3 f = numbered(FortranStorageOrder()), c = numbered(CStorageOrder());
+        CPPUNIT_ASSERT(f.contiguous() && f.rowsContiguous());
+        CPPUNIT_ASSERT(c.contiguous() && ! c.rowsContiguous());
+        CPPUNIT_ASSERT(f.slice(2, 2).contiguous());
+        CPPUNIT_ASSERT(! f.slice(1, 4).contiguous() && ! f.slice(0, 0).contiguous());
+        CPPUNIT_ASSERT(f.slice(1, 4).rowsContiguous() && ! f.slice(0, 0).rowsContiguous());
+        CPPUNIT_ASSERT(c.slice(0, 0).contiguous() && ! c.slice(2, 2).contiguous());
+
+        // A slice keeps the bounds of the dimensions left over
+        Slice s = f.slice(1, 4);
+        CPPUNIT_ASSERT(s.base(0) == -2 && s.extent(0) == 4);
+        CPPUNIT_ASSERT(s.base(1) == 1 && s.extent(1) == 4);
+        CPPUNIT_ASSERT(s(IndexArray(0, 2)) == code(IndexArray3(0, 4, 2)));
+        cerr << '.';
+    }
+
+    // With dimension 0 fastest, memory order is index order; otherwise,
+    // every element is still visited exactly once
+    void test_linear_order() {
+        A3 f = numbered(FortranStorageOrder());
+        IndexArray3 idx(f.bases());
+        A3::ConstLinearIterator p = f.linearBegin();
+        do {
+            CPPUNIT_ASSERT(*p++ == code(idx));
+        } while (nextIndex(idx, f.bounds()));
+        CPPUNIT_ASSERT(p == f.linearEnd());
+
+        A3 c = numbered(CStorageOrder());
+        std::vector<int> seen(c.linearBegin(), c.linearEnd()), expected;
+        idx = c.bases();
+        do {
+            expected.push_back(code(idx));
+        } while (nextIndex(idx, c.bounds()));
+        std::sort(seen.begin(), seen.end());
+        std::sort(expected.begin(), expected.end());
+        CPPUNIT_ASSERT(seen == expected);
+        cerr << '.';
+    }
+
+    void test_fill() {
+        StorageOrder orders[] = { FortranStorageOrder(), CStorageOrder() };
+        for (int o = 0; o < 2; ++o) {
+            A3 a = numbered(orders[o]);
+            CPPUNIT_ASSERT(fillsSlice(a, 0, -2, -1) && fillsSlice(a, 0, 4, -1));
+            CPPUNIT_ASSERT(fillsSlice(a, 1, 5, -1) && fillsSlice(a, 2, 1, -1));
+            CPPUNIT_ASSERT(fillsSlice(a, 2, 4, -1));
+
+            a.fill(-7);
+            IndexArray3 idx(a.bases());
+            do {
+                CPPUNIT_ASSERT(a(idx) == -7);
+            } while (nextIndex(idx, a.bounds()));
+        }
+        cerr << '.';
+    }
+
+    // Whole arrays with the same layout are copied in one sweep, anything
+    // else a row at a time
+    void test_copy() {
+        StorageOrder orders[] = { FortranStorageOrder(), CStorageOrder() };
+        for (int so = 0; so < 2; ++so)
+            for (int dO = 0; dO < 2; ++dO) {
+                A3 src = numbered(orders[so]);
+                A3 whole(src.bounds(), orders[dO]);
+                inca::copy(whole, whole.bases(), src, src.bases(), src.sizes());
+                IndexArray3 idx(src.bases());
+                do {
+                    CPPUNIT_ASSERT(whole(idx) == src(idx));
+                } while (nextIndex(idx, src.bounds()));
+
+                // A piece of it, moved somewhere else (into floats)
+                inca::MultiArray<float, 3> dst(SizeArray3(6, 6, 6), orders[dO]);
+                dst.fill(-1.0f);
+                IndexArray3 from(-1, 4, 2), to(2, 0, 1);
+                SizeArray3 sz(4, 3, 2);
+                inca::copy(dst, to, src, from, sz);
+                idx = dst.bases();
+                do {
+                    IndexArray3 s;
+                    bool inside = true;
+                    for (IndexType d = 0; d < 3; ++d) {
+                        s[d] = idx[d] - to[d] + from[d];
+                        inside = inside && idx[d] >= to[d] && idx[d] < to[d] + IndexType(sz[d]);
+                    }
+                    CPPUNIT_ASSERT(dst(idx) == (inside ? float(src(s)) : -1.0f));
+                } while (nextIndex(idx, dst.bounds()));
+            }
+        cerr << '.';
+    }
+
+    // Rows longer than a span buffer, and rows shorter than one
+    void test_raster_algorithms() {
+        R2 wide(Region(IndexArray(-3, 0), IndexArray(INCA_RASTER_SPAN_BUFFER_SIZE + 40, 2)));
+        scramble(wide);
+        R2 rasters[] = { image, wide };
+        for (int i = 0; i < 2; ++i) {
+            const R2 & r = rasters[i];
+            R2 copied(r.bounds());
+            copy(copied, r);
+            CPPUNIT_ASSERT(same(copied, r));
+
+            MultiArrayRaster<double, 2> converted(r.bounds());
+            copy(converted, r);
+            CPPUNIT_ASSERT(same(converted, r));
+
+            fill(copied, 2.5f);
+            IndexArray idx(r.bases());
+            double total = 0.0;
+            do {
+                CPPUNIT_ASSERT(copied(idx) == 2.5f);
+                total += r(idx);
+            } while (nextIndex(idx, r.bounds()));
+
+            Sum sum = apply(Sum(), r);
+            CPPUNIT_ASSERT(sum.count == r.size());
+            CPPUNIT_ASSERT(sum.total == total);
+        }
+        cerr << '.';
+    }
+
+    // Only the part within the bounds is stored
+    void test_store_span() {
+        std::vector<float> values(image.size(0) + 10);
+        for (SizeType i = 0; i < SizeType(values.size()); ++i)
+            values[i] = -float(i + 1);
+        IndexType starts[] = { image.base(0) - 5, image.base(0) + 4, image.extent(0) - 2 };
+        SizeType lengths[] = { 3, 9, image.size(0) + 10 };
+        for (int s = 0; s < 3; ++s)
+            for (int l = 0; l < 3; ++l) {
+                R2 stored(image.bounds()), expected(image.bounds());
+                copy(stored, image);
+                copy(expected, image);
+                IndexArray start(starts[s], image.base(1) + 2), idx(start);
+                stored.storeSpan(start, lengths[l], &values[0]);
+                for (SizeType i = 0; i < lengths[l]; ++i, ++idx[0])
+                    if (expected.bounds().contains(idx))
+                        expected(idx) = values[i];
+                CPPUNIT_ASSERT(same(stored, expected));
+            }
+        cerr << '.';
+    }
+
+    // A raster over a slice whose rows aren't adjacent in memory
+    void test_strided_rows() {
+        A3 a = numbered(FortranStorageOrder());
+        View2 view(a.slice(0, 1));
+        CPPUNIT_ASSERT(! view.array().rowsContiguous());
+
+        std::vector<int> row(view.size(0) + 4), values(view.size(0));
+        IndexArray idx(view.base(0) - 2, view.base(1) + 1);
+        view.span(idx, SizeType(row.size()), &row[0]);
+        for (SizeType i = 0; i < SizeType(row.size()); ++i, ++idx[0])
+            CPPUNIT_ASSERT(row[i] == view(idx));
+
+        for (SizeType i = 0; i < SizeType(values.size()); ++i)
+            values[i] = -int(i + 1);
+        idx = IndexArray(view.base(0), view.base(1) + 2);
+        view.storeSpan(idx, SizeType(values.size()), &values[0]);
+        IndexArray3 i3(a.bases());
+        do {
+            int expected = code(i3);
+            if (i3[0] == 1 && i3[2] == view.base(1) + 2)
+                expected = -int(i3[1] - view.base(0) + 1);
+            CPPUNIT_ASSERT(a(i3) == expected);
+        } while (nextIndex(i3, a.bounds()));
+        cerr << '.';
+    }
+
+protected:
+    R2              image;      // Some values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+};
+
+#endif
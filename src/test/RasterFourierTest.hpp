@@ -0,0 +1,278 @@
+/* -*- C++ -*-
+ *
+ * File: RasterFourierTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the DFT operators. Real and complex transforms of several
+ *      ranks and odd & even sizes are checked against a DFT computed by
+ *      brute force (which pins down the C storage order), and each inverse
+ *      must undo its forward transform, whether transformed in-place or not,
+ *      and with one or several threads. Repeating a transform must reuse its
+ *      cached plan, while changing its direction, sizes or in-place mode
+ *      must not.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_FOURIER
+#define TEST_RASTER_FOURIER
+
+
+using namespace inca::raster;
+
+
+// Import the operators under test
+#include <inca/raster/operators/fourier>
+
+// Import complex numbers & math functions
+#include <complex>
+#include <cmath>
+
+
+class RasterFourierTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterFourierTest                               ThisTest;
+    typedef std::complex<float>                             Complex;
+    typedef std::complex<double>                            ComplexD;
+    typedef MultiArrayRaster<float, 2>                      R2;
+    typedef MultiArrayRaster<Complex, 2>                    C2;
+    typedef MultiArrayRaster<Complex, 3>                    C3;
+    typedef R2::IndexArray                                  IndexArray;
+    typedef R2::SizeArray                                   SizeArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Fourier tests
+        CPPUNIT_TEST(test_real_vs_naive);
+        CPPUNIT_TEST(test_complex_vs_naive);
+        CPPUNIT_TEST(test_real_round_trip);
+        CPPUNIT_TEST(test_complex_round_trip);
+        CPPUNIT_TEST(test_double_round_trip);
+        CPPUNIT_TEST(test_plan_cache);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Fourier Transforms: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        seed = 12345;
+    }
+
+    void tearDown() {
+        setDFTInPlace(true);
+        setDFTThreadCount(1);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [-1, 1) with no particular structure, the same every time
+    float nextRandom() {
+        seed = seed * 1103515245u + 12345u;
+        return float((seed >> 16) % 2000) / 1000.0f - 1.0f;
+    }
+
+    // Fill 'r' with random reals (or complex numbers)
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            r(idx) = typename R::ElementType(nextRandom());
+        } while (nextIndex(idx, r.bounds()));
+    }
+    template <SizeType dim>
+    void scramble(MultiArrayRaster<Complex, dim> & r) {
+        typename MultiArrayRaster<Complex, dim>::IndexArray idx(r.bases());
+        do {
+            float re = nextRandom();
+            r(idx) = Complex(re, nextRandom());
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // The forward DFT of 'r' at frequency 'k', computed by brute force
+    template <class R, class IndexList>
+    static ComplexD naiveDFT(const R & r, const IndexList & k) {
+        const double pi = 3.14159265358979323846;
+        ComplexD sum(0.0, 0.0);
+        typename R::IndexArray j(r.bases());
+        do {
+            double phase = 0.0;
+            for (IndexType d = 0; d < IndexType(R::dimensionality); ++d)
+                phase += double(k[d] * j[d]) / double(r.size(d));
+            ComplexD x(r(j));
+            sum += x * std::polar(1.0, -2.0 * pi * phase);
+        } while (nextIndex(j, r.bounds()));
+        return sum;
+    }
+
+    // Do 'a' and 'b' have the same bounds, and elements within 'epsilon'?
+    template <class R0, class R1>
+    static bool near(const R0 & a, const R1 & b, double epsilon) {
+        if (a.bases() != b.bases() || a.sizes() != b.sizes())
+            return false;
+        typename R0::IndexArray idx(a.bases());
+        do {
+            if (std::abs(ComplexD(a(idx)) - ComplexD(b(idx))) > epsilon)
+                return false;
+        } while (nextIndex(idx, a.bounds()));
+        return true;
+    }
+
+    // Does the half-result 'f' match a brute-force DFT of 'r'?
+    template <class R, class F>
+    static bool matchesNaive(const R & r, const F & f, double epsilon) {
+        SizeArray sizes(r.sizes());
+        sizes[1] = sizes[1] / 2 + 1;
+        if (f.sizes() != sizes)
+            return false;
+        IndexArray k(f.bases());
+        do {
+            if (std::abs(naiveDFT(r, k) - ComplexD(f(k))) > epsilon)
+                return false;
+        } while (nextIndex(k, f.bounds()));
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Fourier tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Odd & even sizes along the halved (last) dimension, in-place or not
+    void test_real_vs_naive() {
+        SizeArray sizes[] = { SizeArray(5, 7), SizeArray(6, 8), SizeArray(4, 1) };
+        for (int inPlace = 0; inPlace < 2; ++inPlace)
+            for (int s = 0; s < 3; ++s) {
+                setDFTInPlace(inPlace != 0);
+                R2 r(sizes[s]);
+                scramble(r);
+                CPPUNIT_ASSERT(matchesNaive(r, dft(r), 1e-4));
+            }
+        cerr << '.';
+    }
+
+    // Different sizes along each dimension, so a transposed layout would show
+    void test_complex_vs_naive() {
+        C3 r(C3::SizeArray(3, 4, 5));
+        scramble(r);
+        ComplexDFTOperatorRaster<C3> f = cdft(r);
+        CPPUNIT_ASSERT(f.sizes() == r.sizes());
+        C3::IndexArray k(f.bases());
+        do {
+            CPPUNIT_ASSERT(std::abs(naiveDFT(r, k) - ComplexD(f(k))) < 1e-4);
+        } while (nextIndex(k, f.bounds()));
+        cerr << '.';
+    }
+
+    // idft(dft(r)) == r, given the original size of an odd last dimension
+    void test_real_round_trip() {
+        SizeArray sizes[] = { SizeArray(8, 6), SizeArray(7, 5), SizeArray(6, 9),
+                              SizeArray(1, 4), SizeArray(3, 1) };
+        for (SizeType threads = 1; threads <= 2; ++threads)
+            for (int inPlace = 0; inPlace < 2; ++inPlace)
+                for (int s = 0; s < 5; ++s) {
+                    setDFTThreadCount(threads);
+                    setDFTInPlace(inPlace != 0);
+                    R2 r(sizes[s]);
+                    scramble(r);
+                    DFTOperatorRaster<R2> f = dft(r);
+                    CPPUNIT_ASSERT(near(r, idft(f, r.size(1)), 1e-5));
+                    if (r.size(1) % 2 == 0)
+                        CPPUNIT_ASSERT(near(r, idft(f), 1e-5));
+                }
+        cerr << '.';
+    }
+
+    void test_complex_round_trip() {
+        C3 r(C3::SizeArray(4, 3, 7));
+        scramble(r);
+        CPPUNIT_ASSERT(near(r, cidft(cdft(r)), 1e-5));
+
+        C2 s(C2::SizeArray(9, 2));
+        scramble(s);
+        CPPUNIT_ASSERT(near(s, cidft(cdft(s)), 1e-5));
+        cerr << '.';
+    }
+
+    void test_double_round_trip() {
+        MultiArrayRaster<double, 1> r(MultiArrayRaster<double, 1>::SizeArray(11));
+        scramble(r);
+        CPPUNIT_ASSERT(near(r, idft(dft(r), 11), 1e-12));
+        setDFTInPlace(false);
+        CPPUNIT_ASSERT(near(r, idft(dft(r), 11), 1e-12));
+        cerr << '.';
+    }
+
+    // A plan is only made the first time a particular transform is needed
+    void test_plan_cache() {
+        clearDFTPlanCache();
+        CPPUNIT_ASSERT(dftPlanCount() == 0);
+
+        R2 r(SizeArray(6, 10)), s(SizeArray(6, 10)), t(SizeArray(10, 6));
+        scramble(r);
+        scramble(s);
+        scramble(t);
+        dft(r);
+        CPPUNIT_ASSERT(dftPlanCount() == 1);
+        dft(r);
+        dft(s);
+        CPPUNIT_ASSERT(dftPlanCount() == 1);
+
+        CPPUNIT_ASSERT(near(r, idft(dft(r)), 1e-5));   // Backward: a new plan
+        CPPUNIT_ASSERT(dftPlanCount() == 2);
+        dft(t);                                         // New sizes
+        CPPUNIT_ASSERT(dftPlanCount() == 3);
+        setDFTInPlace(false);                           // Out-of-place
+        dft(r);
+        CPPUNIT_ASSERT(dftPlanCount() == 4);
+        CPPUNIT_ASSERT(near(s, idft(dft(s)), 1e-5));
+        CPPUNIT_ASSERT(dftPlanCount() == 5);
+
+        C2 c(C2::SizeArray(6, 10));                     // Complex, each way
+        scramble(c);
+        CPPUNIT_ASSERT(near(c, cidft(cdft(c)), 1e-5));
+        CPPUNIT_ASSERT(dftPlanCount() == 7);
+        cdft(c);
+        CPPUNIT_ASSERT(dftPlanCount() == 7);
+
+        clearDFTPlanCache();
+        CPPUNIT_ASSERT(dftPlanCount() == 0);
+        CPPUNIT_ASSERT(near(r, idft(dft(r)), 1e-5));
+        CPPUNIT_ASSERT(dftPlanCount() == 2);
+        cerr << '.';
+    }
+
+protected:
+    unsigned int seed;      // State of our random number generator
+};
+
+#endif
@@ -0,0 +1,209 @@
+/* -*- C++ -*-
+ *
+ * File: RasterIntegralTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for summed-area tables. The integral built with various thread
+ *      counts & tile sizes, and the box sums & means looked up from it, are
+ *      checked against sums over the box found by brute force, including
+ *      boxes that hang off the edges of the raster.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_INTEGRAL
+#define TEST_RASTER_INTEGRAL
+
+
+using namespace inca::raster;
+
+
+// Import the algorithms under test
+#include <inca/raster/algorithms/integral>
+#include <inca/raster/algorithms/parallel>
+
+// Import math functions
+#include <cmath>
+
+
+class RasterIntegralTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterIntegralTest                      ThisTest;
+    typedef MultiArrayRaster<unsigned char, 3>      R3;
+    typedef R3::Region                              Region;
+    typedef R3::IndexArray                          IndexArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Integral tests
+        CPPUNIT_TEST(test_integral);
+        CPPUNIT_TEST(test_box_sums);
+        CPPUNIT_TEST(test_box_means);
+        CPPUNIT_TEST(test_signed_1d);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Integrals: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+        source = R3(Region(IndexArray(-3, 2, 5), IndexArray(9, 10, 15)));
+        seed = 12345;
+        for (SizeType i = 0; i < source.size(); ++i)
+            source.elements()[i] = (unsigned char)(nextRandom() % 256);
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers with no particular structure, the same every time
+    unsigned int nextRandom() {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 16;
+    }
+
+    // The sum of the elements of 'r' within 'box', and how many there are
+    template <class R, class Box>
+    static double naiveSum(const R & r, const Box & box, SizeType & n) {
+        Box b = intersectionOf(box, r.bounds());
+        double total = 0.0;
+        n = 0;
+        if (b.size() <= 0)
+            return total;
+        typename R::IndexArray idx(b.bases());
+        do {
+            total += double(r(idx));
+            ++n;
+        } while (nextIndex(idx, b));
+        return total;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Integral tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Each element of the integral is the sum of everything at or below it
+    void test_integral() {
+        SizeType tiles[] = { 7, 100, 64 * 1024 };
+        for (SizeType threads = 1; threads <= 3; threads += 2)
+            for (int t = 0; t < 3; ++t) {
+                setEvaluationThreadCount(threads);
+                setEvaluationTileSize(tiles[t]);
+                MultiArrayRaster<unsigned long long, 3> sums = integral(source);
+                CPPUNIT_ASSERT(sums.bases() == source.bases());
+                CPPUNIT_ASSERT(sums.sizes() == source.sizes());
+
+                IndexArray idx(source.bases());
+                SizeType n;
+                do {
+                    Region below(source.bases(), idx);
+                    CPPUNIT_ASSERT(double(sums(idx)) == naiveSum(source, below, n));
+                } while (nextIndex(idx, source.bounds()));
+            }
+        cerr << '.';
+    }
+
+    // Boxes inside, straddling and outside the raster, and empty boxes
+    void test_box_sums() {
+        setEvaluationThreadCount(3);
+        setEvaluationTileSize(100);
+        MultiArrayRaster<unsigned long long, 3> sums = integral(source);
+        for (int q = 0; q < 500; ++q) {
+            IndexArray lo, hi;
+            for (IndexType d = 0; d < 3; ++d) {
+                lo[d] = source.base(d) - 2 + IndexType(nextRandom() % (source.size(d) + 3));
+                hi[d] = lo[d] + IndexType(nextRandom() % 8) - 1;
+            }
+            Region box;
+            box.setBasesAndExtents(lo, hi);
+            SizeType n;
+            double expected = naiveSum(source, box, n);
+            CPPUNIT_ASSERT(double(boxSum(sums, box)) == expected);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(n == 0 ? 0.0 : expected / double(n),
+                                         boxMean(sums, box), 1e-9);
+        }
+        cerr << '.';
+    }
+
+    // A box blur, shrinking at the edges
+    void test_box_means() {
+        MultiArrayRaster<float, 2> r(MultiArrayRaster<float, 2>::SizeArray(50, 40));
+        for (SizeType i = 0; i < r.size(); ++i)
+            r.elements()[i] = float(nextRandom() % 1000) / 8.0f - 60.0f;
+        MultiArrayRaster<double, 2> sums = integral(r);
+
+        Array<SizeType, 2> radii(3, 1);
+        MultiArrayRaster<float, 2> blurred(r.bounds());
+        boxMeans(blurred, sums, radii);
+
+        MultiArrayRaster<float, 2>::IndexArray idx(r.bases());
+        do {
+            MultiArrayRaster<float, 2>::Region box;
+            box.setBasesAndExtents(
+                MultiArrayRaster<float, 2>::IndexArray(idx[0] - 3, idx[1] - 1),
+                MultiArrayRaster<float, 2>::IndexArray(idx[0] + 3, idx[1] + 1));
+            SizeType n;
+            double expected = naiveSum(r, box, n) / double(n);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, blurred(idx), 1e-4);
+        } while (nextIndex(idx, r.bounds()));
+        cerr << '.';
+    }
+
+    // Negative elements must subtract from the sums
+    void test_signed_1d() {
+        MultiArrayRaster<int, 1> r(MultiArrayRaster<int, 1>::SizeArray(10));
+        for (IndexType i = 0; i < 10; ++i)
+            r(Array<IndexType, 1>(i)) = int(i) - 4;
+        MultiArrayRaster<long long, 1> sums = integral(r);
+        CPPUNIT_ASSERT(sums(Array<IndexType, 1>(0)) == -4);
+        CPPUNIT_ASSERT(sums(Array<IndexType, 1>(3)) == -10);
+        CPPUNIT_ASSERT(sums(Array<IndexType, 1>(9)) == 5);
+
+        MultiArrayRaster<int, 1>::Region box;
+        box.setBasesAndExtents(Array<IndexType, 1>(2), Array<IndexType, 1>(6));
+        CPPUNIT_ASSERT(boxSum(sums, box) == 0);
+        cerr << '.';
+    }
+
+protected:
+    R3              source;     // Bytes with no particular structure
+    unsigned int    seed;       // State of our random number generator
+    SizeType        tileSize;   // The evaluation tile size before the test
+};
+
+#endif
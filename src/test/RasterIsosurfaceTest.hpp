@@ -0,0 +1,260 @@
+/* -*- C++ -*-
+ *
+ * File: RasterIsosurfaceTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for marching-cubes isosurface extraction. The surfaces of a
+ *      sphere and of random noise must be closed & consistently oriented
+ *      (every edge used exactly once in each direction), the sphere's
+ *      triangles & normals must face outward, and the mesh must come out
+ *      identical no matter how many threads extract it.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_ISOSURFACE
+#define TEST_RASTER_ISOSURFACE
+
+
+using namespace inca::raster;
+
+
+// Import the algorithms under test
+#include <inca/raster/algorithms/extract_isosurface>
+#include <inca/raster/algorithms/parallel>
+
+// Import containers & math functions
+#include <map>
+#include <set>
+#include <cmath>
+
+
+class RasterIsosurfaceTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterIsosurfaceTest            ThisTest;
+    typedef MultiArrayRaster<float, 3>      R3;
+    typedef R3::IndexArray                  IndexArray;
+    typedef IndexedTriangleMesh<float>      Mesh;
+    typedef std::pair<IndexType, IndexType> Edge;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Isosurface tests
+        CPPUNIT_TEST(test_sphere);
+        CPPUNIT_TEST(test_noise);
+        CPPUNIT_TEST(test_thread_count);
+        CPPUNIT_TEST(test_empty);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Isosurfaces: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+
+        // A sphere of radius 'radius' around 'center', positive inside
+        center[0] = 4.3f;   center[1] = 11.1f;   center[2] = 17.7f;
+        radius = 8.2f;
+        sphere = R3(R3::Region(IndexArray(-7, 0, 6), IndexArray(15, 23, 29)));
+        IndexArray idx(sphere.bases());
+        do {
+            float d2 = 0.0f;
+            for (IndexType d = 0; d < 3; ++d)
+                d2 += (idx[d] - center[d]) * (idx[d] - center[d]);
+            sphere(idx) = radius - std::sqrt(d2);
+        } while (nextIndex(idx, sphere.bounds()));
+
+        // Random values in [0, 1), with a border of zeros so that the
+        // surface can't leave the raster
+        noise = R3(R3::SizeArray(21, 17, 23));
+        unsigned int seed = 12345;
+        idx = noise.bases();
+        do {
+            seed = seed * 1103515245u + 12345u;
+            bool border = false;
+            for (IndexType d = 0; d < 3; ++d)
+                border = border || idx[d] == noise.base(d) || idx[d] == noise.extent(d);
+            noise(idx) = border ? 0.0f : float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, noise.bounds()));
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Is every edge of 'm' used exactly once in each direction?
+    static bool isClosed(const Mesh & m) {
+        std::map<Edge, int> edges;
+        for (SizeType t = 0; t < m.indices.size(); t += 3)
+            for (int k = 0; k < 3; ++k)
+                ++edges[Edge(m.indices[t + k], m.indices[t + (k + 1) % 3])];
+        for (std::map<Edge, int>::const_iterator e = edges.begin(); e != edges.end(); ++e) {
+            std::map<Edge, int>::const_iterator back =
+                edges.find(Edge(e->first.second, e->first.first));
+            if (e->second != 1 || back == edges.end() || back->second != 1)
+                return false;
+        }
+        return true;
+    }
+
+    // The number of distinct (undirected) edges of 'm'
+    static SizeType edgeCount(const Mesh & m) {
+        std::set<Edge> edges;
+        for (SizeType t = 0; t < m.indices.size(); t += 3)
+            for (int k = 0; k < 3; ++k) {
+                IndexType a = m.indices[t + k], b = m.indices[t + (k + 1) % 3];
+                edges.insert(Edge(std::min(a, b), std::max(a, b)));
+            }
+        return SizeType(edges.size());
+    }
+
+    // Do 'a' and 'b' have exactly the same vertices, normals & triangles?
+    static bool identical(const Mesh & a, const Mesh & b) {
+        if (a.vertexCount() != b.vertexCount() || a.indices != b.indices)
+            return false;
+        for (SizeType i = 0; i < a.vertexCount(); ++i)
+            for (IndexType d = 0; d < 3; ++d)
+                if (a.vertices[i][d] != b.vertices[i][d] || a.normals[i][d] != b.normals[i][d])
+                    return false;
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Isosurface tests
+ *---------------------------------------------------------------------------*/
+public:
+    // A closed surface of genus 0, near the sphere and facing out of it
+    void test_sphere() {
+        Mesh m;
+        extract_isosurface(m, sphere, 0.0f, 1, 64 * 1024);
+        CPPUNIT_ASSERT(m.triangleCount() > 0);
+        CPPUNIT_ASSERT(m.normals.size() == m.vertices.size());
+        CPPUNIT_ASSERT(isClosed(m));
+        CPPUNIT_ASSERT(IndexType(m.vertexCount()) - IndexType(edgeCount(m))
+                        + IndexType(m.triangleCount()) == 2);
+
+        // Counter-clockwise seen from outside
+        for (SizeType t = 0; t < m.indices.size(); t += 3) {
+            const Mesh::Point & p0 = m.vertices[m.indices[t]],
+                              & p1 = m.vertices[m.indices[t + 1]],
+                              & p2 = m.vertices[m.indices[t + 2]];
+            float u[3], w[3];
+            for (IndexType d = 0; d < 3; ++d) {
+                u[d] = p1[d] - p0[d];
+                w[d] = p2[d] - p0[d];
+            }
+            float n[3] = { u[1] * w[2] - u[2] * w[1],
+                           u[2] * w[0] - u[0] * w[2],
+                           u[0] * w[1] - u[1] * w[0] };
+            float dot = 0.0f;
+            for (IndexType d = 0; d < 3; ++d)
+                dot += n[d] * (p0[d] - center[d]);
+            CPPUNIT_ASSERT(dot > 0.0f);
+        }
+
+        // On the sphere, with normals pointing away from its center
+        for (SizeType i = 0; i < m.vertexCount(); ++i) {
+            float r2 = 0.0f, dot = 0.0f;
+            for (IndexType d = 0; d < 3; ++d) {
+                float offset = m.vertices[i][d] - center[d];
+                r2  += offset * offset;
+                dot += m.normals[i][d] * offset;
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(radius, std::sqrt(r2), 0.1);
+            CPPUNIT_ASSERT(dot / std::sqrt(r2) > 0.95f);
+        }
+        cerr << '.';
+    }
+
+    // Lots of ambiguous cubes, which must still agree across their faces
+    void test_noise() {
+        SizeType tiles[] = { 1, 64 * 1024 };
+        for (int t = 0; t < 2; ++t) {
+            Mesh m;
+            extract_isosurface(m, noise, 0.5f, 3, tiles[t]);
+            CPPUNIT_ASSERT(m.triangleCount() > 0);
+            CPPUNIT_ASSERT(isClosed(m));
+        }
+        cerr << '.';
+    }
+
+    // The slabs depend only on the tile size, so the thread count mustn't
+    // change anything (and no vertex may be emitted twice at a seam)
+    void test_thread_count() {
+        SizeType tiles[] = { 1, 3000, 64 * 1024 };
+        for (int t = 0; t < 3; ++t) {
+            Mesh serial, parallel;
+            extract_isosurface(serial, sphere, 0.0f, 1, tiles[t]);
+            extract_isosurface(parallel, sphere, 0.0f, 4, tiles[t]);
+            CPPUNIT_ASSERT(identical(serial, parallel));
+            CPPUNIT_ASSERT(isClosed(parallel));
+
+            std::set< std::vector<float> > positions;
+            for (SizeType i = 0; i < parallel.vertexCount(); ++i) {
+                std::vector<float> p(3);
+                for (IndexType d = 0; d < 3; ++d)
+                    p[d] = parallel.vertices[i][d];
+                positions.insert(p);
+            }
+            CPPUNIT_ASSERT(positions.size() == parallel.vertexCount());
+
+            Mesh noisy, noisier;
+            extract_isosurface(noisy, noise, 0.5f, 1, tiles[t]);
+            extract_isosurface(noisier, noise, 0.5f, 4, tiles[t]);
+            CPPUNIT_ASSERT(identical(noisy, noisier));
+        }
+        cerr << '.';
+    }
+
+    // Nothing crosses an isovalue that's above (or below) everything
+    void test_empty() {
+        Mesh m;
+        extract_isosurface(m, sphere, 100.0f);
+        CPPUNIT_ASSERT(m.vertexCount() == 0 && m.triangleCount() == 0);
+        extract_isosurface(m, sphere, -100.0f);
+        CPPUNIT_ASSERT(m.vertexCount() == 0 && m.triangleCount() == 0);
+        cerr << '.';
+    }
+
+protected:
+    R3          sphere, noise;  // The volumes we extract surfaces from
+    float       center[3];      // The sphere's center...
+    float       radius;         // ...and radius
+    SizeType    tileSize;       // The evaluation tile size before the test
+};
+
+#endif
@@ -0,0 +1,245 @@
+/* -*- C++ -*-
+ *
+ * File: RasterLabelingTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for connected-component labeling and flood-filling. The
+ *      components found with various thread counts & tile sizes must
+ *      partition the raster exactly as a breadth-first search does (though
+ *      the labels themselves may differ), and both flood fills must fill
+ *      exactly the component of the seed.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_LABELING
+#define TEST_RASTER_LABELING
+
+
+using namespace inca::raster;
+
+
+// Import the algorithms under test
+#include <inca/raster/algorithms/label_components>
+#include <inca/raster/algorithms/flood_fill>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/parallel>
+
+// Import containers
+#include <deque>
+#include <map>
+
+
+class RasterLabelingTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterLabelingTest                  ThisTest;
+    typedef MultiArrayRaster<int, 3>            R3;
+    typedef MultiArrayRaster<unsigned int, 3>   L3;
+    typedef R3::IndexArray                      IndexArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Labeling tests
+        CPPUNIT_TEST(test_face_connectivity);
+        CPPUNIT_TEST(test_full_connectivity);
+        CPPUNIT_TEST(test_flood_fill);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Labeling: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+        source = R3(R3::SizeArray(23, 17, 13));
+        unsigned int seed = 12345;
+        for (SizeType i = 0; i < source.size(); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            source.elements()[i] = int((seed >> 16) % 3);
+        }
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Label the components of equal value (other than 'background') by
+    // breadth-first search, returning how many there are
+    static SizeType searchComponents(L3 & labels, const R3 & r, int background,
+                                     Connectivity c) {
+        labels = L3(r.bounds());
+        for (SizeType i = 0; i < labels.size(); ++i)
+            labels.elements()[i] = 0;
+
+        unsigned int count = 0;
+        IndexArray start(r.bases());
+        do {
+            if (r(start) == background || labels(start) != 0)
+                continue;
+            labels(start) = ++count;
+            std::deque<IndexArray> todo(1, start);
+            while (! todo.empty()) {
+                IndexArray p = todo.front(), q;
+                todo.pop_front();
+                IndexArray offset(-1);
+                do {
+                    int moved = 0;
+                    for (IndexType d = 0; d < 3; ++d) {
+                        q[d] = p[d] + offset[d];
+                        moved += (offset[d] != 0);
+                    }
+                    if (moved == 0 || (c == FaceConnectivity && moved > 1)
+                            || ! r.bounds().contains(q)
+                            || labels(q) != 0 || r(q) != r(p))
+                        continue;
+                    labels(q) = count;
+                    todo.push_back(q);
+                } while (nextOffset(offset));
+            }
+        } while (nextIndex(start, r.bounds()));
+        return count;
+    }
+
+    // Step through the 3^N offsets in {-1, 0, 1}
+    static bool nextOffset(IndexArray & offset) {
+        for (IndexType d = 0; d < 3; ++d) {
+            if (++offset[d] <= 1)
+                return true;
+            offset[d] = -1;
+        }
+        return false;
+    }
+
+    // Do 'a' and 'b' group the elements the same way (with 0 meaning the
+    // same thing in both)?
+    static bool samePartition(const L3 & a, const L3 & b) {
+        std::map<unsigned int, unsigned int> forward, backward;
+        for (SizeType i = 0; i < a.size(); ++i) {
+            unsigned int x = a.elements()[i], y = b.elements()[i];
+            if ((x == 0) != (y == 0))
+                return false;
+            if (x == 0)
+                continue;
+            if ((forward.count(x) && forward[x] != y) || (backward.count(y) && backward[y] != x))
+                return false;
+            forward[x] = y;
+            backward[y] = x;
+        }
+        return true;
+    }
+
+    // Label with various thread counts & tile sizes, and compare with BFS
+    void checkLabeling(Connectivity c) {
+        L3 expected;
+        SizeType count = searchComponents(expected, source, 0, c);
+        SizeType tiles[] = { 100, 1000, 64 * 1024 };
+        for (SizeType threads = 1; threads <= 4; threads += 3)
+            for (int t = 0; t < 3; ++t) {
+                setEvaluationThreadCount(threads);
+                setEvaluationTileSize(tiles[t]);
+                L3 labels(source.bounds());
+                CPPUNIT_ASSERT(label_components(labels, source, 0, c) == count);
+                CPPUNIT_ASSERT(samePartition(labels, expected));
+
+                // Labels are numbered consecutively from 1
+                unsigned int highest = 0;
+                for (SizeType i = 0; i < labels.size(); ++i)
+                    highest = std::max(highest, labels.elements()[i]);
+                CPPUNIT_ASSERT(highest == count);
+            }
+        cerr << '.';
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Labeling tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_face_connectivity() {
+        checkLabeling(FaceConnectivity);
+    }
+
+    void test_full_connectivity() {
+        checkLabeling(FullConnectivity);
+    }
+
+    // Both fills must fill exactly the seed's face-connected region, and
+    // must refuse a seed outside the raster
+    void test_flood_fill() {
+        L3 components;
+        searchComponents(components, source, -1, FaceConnectivity);
+        IndexArray seed(5, 5, 5);
+        unsigned int label = components(seed);
+        SizeType expected = 0;
+        for (SizeType i = 0; i < components.size(); ++i)
+            expected += (components.elements()[i] == label);
+
+        setEvaluationThreadCount(4);
+        setEvaluationTileSize(500);
+        R3 serial(source.bounds()), parallel(source.bounds());
+        copy(serial, source);
+        copy(parallel, source);
+        CPPUNIT_ASSERT(flood_fill(serial, seed, 9).second == expected);
+        CPPUNIT_ASSERT(parallel_flood_fill(parallel, seed, 9).second == expected);
+        for (SizeType i = 0; i < components.size(); ++i) {
+            bool filled = (components.elements()[i] == label);
+            CPPUNIT_ASSERT((serial.elements()[i] == 9) == filled);
+            CPPUNIT_ASSERT((parallel.elements()[i] == 9) == filled);
+        }
+
+        // A seed outside the raster is an error
+        bool threw = false;
+        try {
+            flood_fill(serial, IndexArray(5, 17, 5), 9);
+        } catch (OutOfBoundsException &) {
+            threw = true;
+        }
+        CPPUNIT_ASSERT(threw);
+        threw = false;
+        try {
+            parallel_flood_fill(parallel, IndexArray(-1, 5, 5), 9);
+        } catch (OutOfBoundsException &) {
+            threw = true;
+        }
+        CPPUNIT_ASSERT(threw);
+        cerr << '.';
+    }
+
+protected:
+    R3          source;     // Three kinds of elements, all mixed up
+    SizeType    tileSize;   // The evaluation tile size before the test
+};
+
+#endif
@@ -0,0 +1,166 @@
+/* -*- C++ -*-
+ *
+ * File: RasterMappedTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for memory-mapped rasters. Rasters with various bounds and
+ *      storage orders are written to a file, mapped again, and must come
+ *      back with the same bounds and elements.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_MAPPED
+#define TEST_RASTER_MAPPED
+
+
+using namespace inca::raster;
+
+
+// Import the raster under test
+#include <inca/raster/MappedMultiArrayRaster>
+
+// Import file functions
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+
+class RasterMappedTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterMappedTest                ThisTest;
+    typedef MappedMultiArrayRaster<int, 2>  R2;
+    typedef R2::Region                      Region;
+    typedef R2::IndexArray                  IndexArray;
+    typedef R2::SizeArray                   SizeArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Mapping tests
+        CPPUNIT_TEST(test_round_trip);
+        CPPUNIT_TEST(test_private_mapping);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Mapped Rasters: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        std::ostringstream name;
+        name << "/tmp/inca-mapped-test-" << ::getpid() << ".raster";
+        filename = name.str();
+    }
+
+    void tearDown() {
+        std::remove(filename.c_str());
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // A value unique to each element
+    static int valueAt(const IndexArray & idx) {
+        return int(idx[0] * 1000 + idx[1]);
+    }
+
+    // Write a raster covering 'b', map it again, and check what we get
+    void roundTrip(const Region & b, const R2::StorageOrder & so) {
+        {
+            R2 r(filename, b, so);
+            CPPUNIT_ASSERT(r.bases() == b.bases());
+            CPPUNIT_ASSERT(r.sizes() == b.sizes());
+            IndexArray idx;
+            for (idx[1] = b.base(1); idx[1] <= b.extent(1); ++idx[1])
+                for (idx[0] = b.base(0); idx[0] <= b.extent(0); ++idx[0])
+                    r(idx) = valueAt(idx);
+            r.flush();
+        }
+
+        R2 r(filename);
+        CPPUNIT_ASSERT(r.bases() == b.bases());
+        CPPUNIT_ASSERT(r.sizes() == b.sizes());
+        for (IndexType d = 0; d < 2; ++d) {
+            CPPUNIT_ASSERT(r.array().storageOrder().order(d) == so.order(d));
+            CPPUNIT_ASSERT(r.array().storageOrder().ascending(d) == so.ascending(d));
+        }
+        IndexArray idx;
+        for (idx[1] = b.base(1); idx[1] <= b.extent(1); ++idx[1])
+            for (idx[0] = b.base(0); idx[0] <= b.extent(0); ++idx[0])
+                CPPUNIT_ASSERT(r(idx) == valueAt(idx));
+
+        // Every element must have its own place in the file
+        const R2 & cr = r;
+        const int * lo = cr.elements(), * hi = cr.elements();
+        for (idx[1] = b.base(1); idx[1] <= b.extent(1); ++idx[1])
+            for (idx[0] = b.base(0); idx[0] <= b.extent(0); ++idx[0]) {
+                lo = std::min(lo, &cr(idx));
+                hi = std::max(hi, &cr(idx));
+            }
+        CPPUNIT_ASSERT(hi - lo + 1 == r.size());
+        cerr << '.';
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Mapping tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_round_trip() {
+        roundTrip(Region(IndexArray(0, 0), IndexArray(4, 3)), FortranStorageOrder());
+        roundTrip(Region(IndexArray(-2, 3), IndexArray(2, 6)), FortranStorageOrder());
+        roundTrip(Region(IndexArray(-2, 3), IndexArray(2, 6)), CStorageOrder());
+        roundTrip(Region(IndexArray(10, 20), IndexArray(14, 23)), FortranStorageOrder());
+    }
+
+    // Changes to a private mapping must survive any advice we give, and
+    // must never reach the file
+    void test_private_mapping() {
+        Region b(IndexArray(-2, 3), IndexArray(2, 6));
+        {
+            R2 r(filename, b);
+            r.flush();
+        }
+
+        R2 r(filename, PrivateMapping);
+        r(IndexArray(-1, 4)) = 17;
+        r.advise(DontNeedAccess);
+        CPPUNIT_ASSERT(r(IndexArray(-1, 4)) == 17);
+
+        R2 other(filename);
+        CPPUNIT_ASSERT(other(IndexArray(-1, 4)) == 0);
+        cerr << '.';
+    }
+
+protected:
+    std::string filename;   // Where we put our rasters
+};
+
+#endif
@@ -0,0 +1,264 @@
+/* -*- C++ -*-
+ *
+ * File: RasterMorphologyTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the morphology operators. Grayscale and binary erosion,
+ *      dilation, opening and closing are checked against the min/max over
+ *      the (clipped) box around each element, found by brute force, and are
+ *      read both an element and a span at a time. Reads beyond the edges
+ *      must get the nearest element, as for a MultiArrayRaster.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_MORPHOLOGY
+#define TEST_RASTER_MORPHOLOGY
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/morphology>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/parallel>
+
+// Import standard algorithms & containers
+#include <algorithm>
+#include <vector>
+
+
+class RasterMorphologyTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterMorphologyTest                    ThisTest;
+    typedef MultiArrayRaster<unsigned char, 2>      R2;
+    typedef MultiArrayRaster<float, 3>              R3;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Morphology tests
+        CPPUNIT_TEST(test_grayscale_2d);
+        CPPUNIT_TEST(test_grayscale_3d);
+        CPPUNIT_TEST(test_binary_2d);
+        CPPUNIT_TEST(test_binary_3d);
+        CPPUNIT_TEST(test_out_of_bounds);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Morphology: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some values for 'r' with no particular structure
+    template <class R>
+    static void scramble(R & r, unsigned int seed) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = typename R::ElementType((seed >> 16) % 256);
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // The min (or max) of 'r' over the box within 'radii' of each element
+    template <class R, class SizeList>
+    static MultiArrayRaster<typename R::ElementType, R::dimensionality>
+    naive(const R & r, const SizeList & radii, bool maximum) {
+        typedef typename R::ElementType T;
+        typedef typename R::IndexArray  IndexArray;
+        typedef typename R::Region      Region;
+        MultiArrayRaster<T, R::dimensionality> result(r.bounds());
+        IndexArray idx(r.bases()), bs, ex;
+        do {
+            for (IndexType d = 0; d < R::dimensionality; ++d) {
+                bs[d] = std::max(idx[d] - IndexType(radii[d]), r.base(d));
+                ex[d] = std::min(idx[d] + IndexType(radii[d]), r.extent(d));
+            }
+            Region box;
+            box.setBasesAndExtents(bs, ex);
+            IndexArray j(box.bases());
+            T v = r(j);
+            do {
+                v = maximum ? std::max(v, T(r(j))) : std::min(v, T(r(j)));
+            } while (nextIndex(j, box));
+            result(idx) = v;
+        } while (nextIndex(idx, r.bounds()));
+        return result;
+    }
+
+    // Does 'r' have the same elements as 'expected', whether read one at a
+    // time or a span at a time?
+    template <class R0, class R1>
+    static bool matches(const R0 & expected, const R1 & r) {
+        MultiArrayRaster<typename R1::ElementType, R1::dimensionality> spans(r.bounds());
+        copy(spans, r);
+        typename R0::IndexArray idx(expected.bases());
+        do {
+            if (expected(idx) != r(idx) || expected(idx) != spans(idx))
+                return false;
+        } while (nextIndex(idx, expected.bounds()));
+        return true;
+    }
+
+    // Does 'r' extend 'expected' beyond its edges with the nearest element,
+    // whether read one at a time or in runs hanging off either end?
+    template <class R0, class R1>
+    static bool extendsNearest(const R0 & expected, const R1 & r) {
+        typedef typename R0::IndexArray  IndexArray;
+        std::vector<int> buffer(expected.size(0) + 8);
+        IndexArray idx;
+        for (idx[1] = expected.base(1) - 3; idx[1] <= expected.extent(1) + 3; ++idx[1]) {
+            for (idx[0] = expected.base(0) - 3; idx[0] <= expected.extent(0) + 3; ++idx[0])
+                if (r(idx) != expected(expected.bounds().nearest(idx)))
+                    return false;
+            IndexArray start(expected.base(0) - 4, idx[1]), element(start);
+            r.span(start, SizeType(buffer.size()), &buffer[0]);
+            for (SizeType i = 0; i < SizeType(buffer.size()); ++i, ++element[0])
+                if (buffer[i] != int(expected(expected.bounds().nearest(element))))
+                    return false;
+        }
+        return true;
+    }
+
+    // The mask of the non-zero elements of 'r'
+    template <class R>
+    static MultiArrayRaster<bool, R::dimensionality> maskOf(const R & r) {
+        MultiArrayRaster<bool, R::dimensionality> m(r.bounds());
+        typename R::IndexArray idx(r.bases());
+        do {
+            m(idx) = (r(idx) != 0);
+        } while (nextIndex(idx, r.bounds()));
+        return m;
+    }
+
+    // Check all the binary operators on the non-zero elements of 'r'
+    template <class R, class SizeList>
+    static void checkBinary(const R & r, const SizeList & radii) {
+        MultiArrayRaster<bool, R::dimensionality> m = maskOf(r);
+        CPPUNIT_ASSERT(matches(naive(m, radii, false), binaryErode(r, radii)));
+        CPPUNIT_ASSERT(matches(naive(m, radii, true),  binaryDilate(r, radii)));
+        CPPUNIT_ASSERT(matches(naive(naive(m, radii, false), radii, true),
+                               binaryOpening(r, radii)));
+        CPPUNIT_ASSERT(matches(naive(naive(m, radii, true), radii, false),
+                               binaryClosing(r, radii)));
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Morphology tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_grayscale_2d() {
+        R2 r(R2::Region(R2::IndexArray(-3, 2), R2::IndexArray(49, 30)));
+        scramble(r, 1);
+        for (SizeType radius = 0; radius <= 5; ++radius) {
+            Array<SizeType, 2> radii(radius, 5 - radius);
+            CPPUNIT_ASSERT(matches(naive(r, radii, false), erode(r, radii)));
+            CPPUNIT_ASSERT(matches(naive(r, radii, true),  dilate(r, radii)));
+            CPPUNIT_ASSERT(matches(naive(naive(r, radii, false), radii, true),
+                                   opening(r, radii)));
+            CPPUNIT_ASSERT(matches(naive(naive(r, radii, true), radii, false),
+                                   closing(r, radii)));
+        }
+
+        // A box bigger than the raster
+        Array<SizeType, 2> huge(100, 1);
+        CPPUNIT_ASSERT(matches(naive(r, huge, false), erode(r, huge)));
+        cerr << '.';
+    }
+
+    void test_grayscale_3d() {
+        R3 r(R3::SizeArray(19, 11, 13));
+        scramble(r, 2);
+        Array<SizeType, 3> radii(2, 1, 3);
+        CPPUNIT_ASSERT(matches(naive(r, radii, false), erode(r, radii)));
+        CPPUNIT_ASSERT(matches(naive(r, radii, true),  dilate(r, radii)));
+        cerr << '.';
+    }
+
+    // Rows of exactly one word, of more than one, and ending part-way
+    // through a word
+    void test_binary_2d() {
+        SizeType widths[] = { 1, 63, 64, 65, 128, 150 };
+        for (int w = 0; w < 6; ++w) {
+            R2 r(R2::SizeArray(widths[w], 17));
+            scramble(r, 3 + w);
+            R2::IndexArray idx(r.bases());
+            do {
+                r(idx) = (r(idx) > 80) ? 255 : 0;
+            } while (nextIndex(idx, r.bounds()));
+
+            checkBinary(r, Array<SizeType, 2>(0, 0));
+            checkBinary(r, Array<SizeType, 2>(1, 2));
+            checkBinary(r, Array<SizeType, 2>(3, 0));
+            checkBinary(r, Array<SizeType, 2>(40, 1));
+            checkBinary(r, Array<SizeType, 2>(200, 20));
+        }
+        cerr << '.';
+    }
+
+    void test_binary_3d() {
+        MultiArrayRaster<bool, 3> r(MultiArrayRaster<bool, 3>::SizeArray(70, 9, 11));
+        R3 values(r.bounds());
+        scramble(values, 9);
+        MultiArrayRaster<bool, 3>::IndexArray idx(r.bases());
+        do {
+            r(idx) = (values(idx) > 100);
+        } while (nextIndex(idx, r.bounds()));
+        checkBinary(r, Array<SizeType, 3>(3, 2, 4));
+        cerr << '.';
+    }
+
+    // Reading from outside the raster, including a mask of more than one
+    // word per row, based away from zero
+    void test_out_of_bounds() {
+        R2 r(R2::Region(R2::IndexArray(-5, 4), R2::IndexArray(70, 20)));
+        scramble(r, 10);
+        Array<SizeType, 2> radii(2, 1);
+        CPPUNIT_ASSERT(extendsNearest(naive(r, radii, false), erode(r, radii)));
+        CPPUNIT_ASSERT(extendsNearest(naive(r, radii, true),  dilate(r, radii)));
+
+        R2::IndexArray idx(r.bases());
+        do {
+            r(idx) = (r(idx) > 150) ? 1 : 0;
+        } while (nextIndex(idx, r.bounds()));
+        MultiArrayRaster<bool, 2> m = maskOf(r);
+        CPPUNIT_ASSERT(extendsNearest(naive(m, radii, false), binaryErode(r, radii)));
+        CPPUNIT_ASSERT(extendsNearest(naive(m, radii, true),  binaryDilate(r, radii)));
+        CPPUNIT_ASSERT(extendsNearest(naive(m, Array<SizeType, 2>(1, 1), true),
+                                      binaryDilate(m, 1)));
+        cerr << '.';
+    }
+};
+
+#endif
@@ -0,0 +1,282 @@
+/* -*- C++ -*-
+ *
+ * File: RasterPyramidTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the image pyramid. Each level must match a reduction
+ *      computed by brute force (smoothing the previous level with the whole
+ *      5^N binomial kernel at once, clamping at the edges, and keeping every
+ *      second element), for odd and even sizes, in 2D and 3D, and for
+ *      integer elements. Building lazily or with several threads must give
+ *      the same levels as building eagerly with one.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_PYRAMID
+#define TEST_RASTER_PYRAMID
+
+
+using namespace inca::raster;
+
+
+// Import the container under test
+#include <inca/raster/Pyramid>
+#include <inca/raster/MultiArrayRaster>
+
+// Import math functions
+#include <cmath>
+
+
+class RasterPyramidTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterPyramidTest                   ThisTest;
+    typedef MultiArrayRaster<float, 2>          R2;
+    typedef R2::Region                          Region;
+    typedef R2::IndexArray                      IndexArray;
+    typedef R2::SizeArray                       SizeArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Pyramid tests
+        CPPUNIT_TEST(test_levels_2d);
+        CPPUNIT_TEST(test_levels_3d);
+        CPPUNIT_TEST(test_integer_elements);
+        CPPUNIT_TEST(test_lazy_and_threads);
+        CPPUNIT_TEST(test_level_access);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Pyramids: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+        seed = 12345;
+        image = R2(Region(IndexArray(-3, 4), IndexArray(33, 25)));
+        scramble(image);
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [0, 255) with no particular structure, the same every time
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = typename R::ElementType((seed >> 16) % 255);
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // The next level down from 'r' (which is based at zero), smoothed with
+    // the whole binomial kernel at once
+    template <class R>
+    static MultiArrayRaster<double, R::dimensionality> naiveReduce(const R & r) {
+        typedef typename R::IndexArray  IndexArray;
+        typedef typename R::SizeArray   SizeArray;
+        typedef typename R::Region      Region;
+        const SizeType dim = R::dimensionality;
+        const double weights[] = { 0.0625, 0.25, 0.375, 0.25, 0.0625 };
+
+        SizeArray sz;
+        for (IndexType d = 0; d < IndexType(dim); ++d)
+            sz[d] = (r.size(d) + 1) / 2;
+        MultiArrayRaster<double, dim> result(sz);
+        Region taps;
+        taps.setSizes(SizeArray(5));
+        IndexArray i(result.bases()), k, src;
+        do {
+            double sum = 0.0;
+            k = taps.bases();
+            do {
+                double weight = 1.0;
+                for (IndexType d = 0; d < IndexType(dim); ++d) {
+                    if (r.size(d) == 1) {           // Not reduced along d
+                        weight *= (k[d] == 2) ? 1.0 : 0.0;
+                    } else {
+                        weight *= weights[k[d]];
+                    }
+                    src[d] = std::max(IndexType(0), std::min(IndexType(r.size(d) - 1),
+                                                             2 * i[d] + k[d] - 2));
+                }
+                if (weight != 0.0)
+                    sum += weight * double(r(src));
+            } while (nextIndex(k, taps));
+            result(i) = sum;
+        } while (nextIndex(i, result.bounds()));
+        return result;
+    }
+
+    // A copy of 'r', moved to the origin (as pyramid levels are)
+    template <class R>
+    static MultiArrayRaster<double, R::dimensionality> atOrigin(const R & r) {
+        MultiArrayRaster<double, R::dimensionality> result(r.sizes());
+        typename R::IndexArray idx(r.bases()), dst;
+        do {
+            for (IndexType d = 0; d < IndexType(R::dimensionality); ++d)
+                dst[d] = idx[d] - r.base(d);
+            result(dst) = double(r(idx));
+        } while (nextIndex(idx, r.bounds()));
+        return result;
+    }
+
+    // The largest difference between 'expected' and 'r'
+    template <class E, class R>
+    static double difference(const E & expected, const R & r) {
+        if (r.sizes() != expected.sizes())
+            return 1e10;
+        double worst = 0.0;
+        typename R::IndexArray idx(r.bases());
+        do {
+            worst = std::max(worst, std::abs(double(expected(idx)) - double(r(idx))));
+        } while (nextIndex(idx, r.bounds()));
+        return worst;
+    }
+
+    // Does every level of 'p' match the brute-force reduction of 'r'?
+    template <class P, class R>
+    static bool reducesCorrectly(const P & p, const R & r, double epsilon) {
+        MultiArrayRaster<double, R::dimensionality> expected = atOrigin(r);
+        for (SizeType l = 0; l < p.levels(); ++l) {
+            if (l > 0)
+                expected = naiveReduce(expected);
+            if (difference(expected, p.level(l)) > epsilon)
+                return false;
+        }
+        return true;
+    }
+
+    // Are the same levels built, to the last bit?
+    template <class P>
+    static bool identical(const P & a, const P & b) {
+        if (a.levels() != b.levels() || a.elementCount() != b.elementCount())
+            return false;
+        for (SizeType l = 0; l < a.levels(); ++l)
+            if (difference(a.level(l), b.level(l)) != 0.0)
+                return false;
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Pyramid tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Odd & even sizes, reaching a single element along one dimension
+    // before the other
+    void test_levels_2d() {
+        Pyramid<float, 2> p = pyramid(image);
+        CPPUNIT_ASSERT(p.levels() == 7);        // 37x22 ... 1x1
+        CPPUNIT_ASSERT(p.sizes(1) == SizeArray(19, 11));
+        CPPUNIT_ASSERT(p.sizes(5) == SizeArray(2, 1));
+        CPPUNIT_ASSERT(p.sizes(6) == SizeArray(1, 1));
+        CPPUNIT_ASSERT(reducesCorrectly(p, image, 1e-3));
+
+        R2 row(SizeArray(40, 1));
+        scramble(row);
+        CPPUNIT_ASSERT(reducesCorrectly(pyramid(row), row, 1e-3));
+        cerr << '.';
+    }
+
+    void test_levels_3d() {
+        MultiArrayRaster<float, 3> r(MultiArrayRaster<float, 3>::SizeArray(9, 5, 12));
+        scramble(r);
+        Pyramid<float, 3> p = pyramid(r);
+        CPPUNIT_ASSERT(p.levels() == 5);
+        CPPUNIT_ASSERT(reducesCorrectly(p, r, 1e-3));
+        cerr << '.';
+    }
+
+    // Rounded only at the end of each level, so each level is within a
+    // rounding of the brute-force reduction of the (rounded) level before
+    void test_integer_elements() {
+        MultiArrayRaster<unsigned char, 2> r(image.bounds());
+        scramble(r);
+        Pyramid<unsigned char, 2> p = pyramid(r);
+        for (SizeType l = 1; l < p.levels(); ++l)
+            CPPUNIT_ASSERT(difference(naiveReduce(p.level(l - 1)), p.level(l)) <= 0.5 + 1e-3);
+        cerr << '.';
+    }
+
+    void test_lazy_and_threads() {
+        setEvaluationTileSize(32);
+        Pyramid<float, 2> eager = pyramid(image),
+                          lazy  = pyramid(image, 0, true);
+        CPPUNIT_ASSERT(lazy.isBuilt(0) && ! lazy.isBuilt(1));
+        lazy.level(3);
+        CPPUNIT_ASSERT(lazy.isBuilt(3) && ! lazy.isBuilt(4));
+        CPPUNIT_ASSERT(identical(eager, lazy));
+        CPPUNIT_ASSERT(lazy.isBuilt(lazy.levels() - 1));
+
+        setEvaluationThreadCount(4);
+        CPPUNIT_ASSERT(identical(eager, pyramid(image)));
+        cerr << '.';
+    }
+
+    void test_level_access() {
+        Pyramid<float, 2> p = pyramid(image, 3);
+        CPPUNIT_ASSERT(p.levels() == 3);
+        CPPUNIT_ASSERT(reducesCorrectly(p, image, 1e-3));
+
+        bool threw = false;
+        try {
+            p.level(3);
+        } catch (OutOfBoundsException &) {
+            threw = true;
+        }
+        CPPUNIT_ASSERT(threw);
+
+        // The coarsest level with at least one element per output element
+        CPPUNIT_ASSERT(p.levelFor(1.0) == 0);
+        CPPUNIT_ASSERT(p.levelFor(0.5) == 1);
+        CPPUNIT_ASSERT(p.levelFor(0.3) == 1);
+        CPPUNIT_ASSERT(p.levelFor(0.25) == 2);
+        CPPUNIT_ASSERT(p.levelFor(0.01) == 2);
+
+        Pyramid<float, 2> empty;
+        CPPUNIT_ASSERT(empty.levels() == 0);
+        cerr << '.';
+    }
+
+protected:
+    R2              image;      // Some values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+    SizeType        tileSize;   // The evaluation tile size before the test
+};
+
+#endif
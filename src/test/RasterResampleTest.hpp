@@ -0,0 +1,277 @@
+/* -*- C++ -*-
+ *
+ * File: RasterResampleTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for separable resampling. For each filter, magnifying,
+ *      minifying and mixed resamplings must match a non-separable resampling
+ *      computed by brute force (weighting the whole box of input elements
+ *      under each output element at once), whatever order the passes are
+ *      done in and however many threads do them. Integer elements must be
+ *      rounded and clamped, and flat rasters must stay flat.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_RESAMPLE
+#define TEST_RASTER_RESAMPLE
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/resample>
+#include <inca/raster/algorithms/copy>
+#include <inca/raster/algorithms/fill>
+
+// Import math functions
+#include <cmath>
+
+
+class RasterResampleTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterResampleTest                  ThisTest;
+    typedef MultiArrayRaster<float, 2>          R2;
+    typedef MultiArrayRaster<float, 3>          R3;
+    typedef MultiArrayRaster<unsigned char, 2>  B2;
+    typedef R2::Region                          Region;
+    typedef R2::IndexArray                      IndexArray;
+    typedef R2::SizeArray                       SizeArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Resample tests
+        CPPUNIT_TEST(test_weights);
+        CPPUNIT_TEST(test_filters_2d);
+        CPPUNIT_TEST(test_filters_3d);
+        CPPUNIT_TEST(test_threads);
+        CPPUNIT_TEST(test_integer_elements);
+        CPPUNIT_TEST(test_flat);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Separable Resampling: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        tileSize = evaluationTileSize();
+        seed = 12345;
+        image = R2(Region(IndexArray(-3, 4), IndexArray(26, 22)));
+        scramble(image);
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+        setEvaluationTileSize(tileSize);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [0, 255) with no particular structure, the same every time
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = typename R::ElementType((seed >> 16) % 255);
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // Resample 'r' to 'sizes' all at once, weighting each element of the
+    // box under an output element by the product of its 1D weights
+    template <class R, class SizeList>
+    static MultiArrayRaster<double, R::dimensionality>
+    naiveResample(const R & r, const SizeList & sizes, ResampleFilter f) {
+        typedef typename R::IndexArray      IndexArray;
+        typedef typename R::Region          Region;
+        const SizeType dim = R::dimensionality;
+        Array<ResampleWeights<float>, dim> w;
+        IndexArray widths;
+        for (IndexType d = 0; d < IndexType(dim); ++d) {
+            w[d] = ResampleWeights<float>(r.size(d), sizes[d], f);
+            widths[d] = w[d].width();
+        }
+
+        Region out, box;
+        out.setBasesAndSizes(r.bases(), sizes);
+        box.setSizes(widths);
+        MultiArrayRaster<double, dim> result(out);
+        IndexArray j(out.bases()), k, src;
+        do {
+            double sum = 0.0;
+            k = box.bases();
+            do {
+                double weight = 1.0;
+                for (IndexType d = 0; d < IndexType(dim); ++d) {
+                    IndexType jd = j[d] - out.base(d);
+                    weight *= w[d].weights(jd)[k[d]];
+                    src[d] = r.base(d) + w[d].first(jd) + k[d];
+                }
+                sum += weight * double(r(src));
+            } while (nextIndex(k, box));
+            result(j) = sum;
+        } while (nextIndex(j, out));
+        return result;
+    }
+
+    // The largest difference between 'expected' and 'r', whether read one
+    // element at a time or a span at a time
+    template <class E, class R>
+    static double difference(const E & expected, const R & r) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return 1e10;
+        MultiArrayRaster<typename R::ElementType, R::dimensionality> spans(r.bounds());
+        copy(spans, r);
+        double worst = 0.0;
+        typename R::IndexArray idx(r.bases());
+        do {
+            worst = std::max(worst, std::abs(double(expected(idx)) - double(r(idx))));
+            worst = std::max(worst, std::abs(double(expected(idx)) - double(spans(idx))));
+        } while (nextIndex(idx, r.bounds()));
+        return worst;
+    }
+
+    // Does each filter resample 'r' to 'sizes' like the brute-force version?
+    template <class R, class SizeList>
+    static bool resamplesCorrectly(const R & r, const SizeList & sizes) {
+        ResampleFilter filters[] = { BoxResample, LinearResample,
+                                     CubicResample, LanczosResample };
+        for (int f = 0; f < 4; ++f)
+            if (difference(naiveResample(r, sizes, filters[f]),
+                           resampleTo(r, sizes, filters[f])) > 1e-3)
+                return false;
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Resample tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Every output element's weights sum to one, and stay within the input
+    void test_weights() {
+        ResampleFilter filters[] = { BoxResample, LinearResample,
+                                     CubicResample, LanczosResample };
+        SizeType sizes[][2] = { { 10, 37 }, { 37, 10 }, { 5, 1 }, { 1, 6 }, { 8, 8 } };
+        for (int f = 0; f < 4; ++f)
+            for (int s = 0; s < 5; ++s) {
+                ResampleWeights<float> w(sizes[s][0], sizes[s][1], filters[f]);
+                CPPUNIT_ASSERT(w.width() >= 1 && w.width() <= sizes[s][0]);
+                for (IndexType j = 0; j < sizes[s][1]; ++j) {
+                    CPPUNIT_ASSERT(w.first(j) >= 0);
+                    CPPUNIT_ASSERT(w.first(j) + IndexType(w.width()) <= sizes[s][0]);
+                    double sum = 0.0;
+                    for (SizeType k = 0; k < w.width(); ++k)
+                        sum += w.weights(j)[k];
+                    CPPUNIT_ASSERT(std::abs(sum - 1.0) < 1e-5);
+                }
+            }
+        cerr << '.';
+    }
+
+    void test_filters_2d() {
+        CPPUNIT_ASSERT(resamplesCorrectly(image, SizeArray(61, 40)));   // Magnify
+        CPPUNIT_ASSERT(resamplesCorrectly(image, SizeArray(9, 6)));     // Minify
+        CPPUNIT_ASSERT(resamplesCorrectly(image, SizeArray(70, 5)));    // Both
+        CPPUNIT_ASSERT(resamplesCorrectly(image, SizeArray(4, 50)));
+        CPPUNIT_ASSERT(resamplesCorrectly(image, SizeArray(30, 11)));   // One axis
+
+        // Only the dimensions that change size take a pass
+        CPPUNIT_ASSERT(resampleTo(image, SizeArray(30, 11)).passCount() == 1);
+        CPPUNIT_ASSERT(resampleTo(image, SizeArray(61, 40)).passCount() == 2);
+        CPPUNIT_ASSERT(resampleTo(image, image.sizes()).passCount() == 0);
+        CPPUNIT_ASSERT(difference(image, resampleTo(image, image.sizes())) == 0.0);
+        cerr << '.';
+    }
+
+    // Passes along dimensions other than 0 work on whole rows, in whatever
+    // order is cheapest
+    void test_filters_3d() {
+        R3 r(R3::Region(R3::IndexArray(2, -1, 5), R3::IndexArray(13, 9, 12)));
+        scramble(r);
+        CPPUNIT_ASSERT(resamplesCorrectly(r, R3::SizeArray(5, 20, 4)));
+        CPPUNIT_ASSERT(resamplesCorrectly(r, R3::SizeArray(25, 3, 16)));
+        CPPUNIT_ASSERT(resamplesCorrectly(r, R3::SizeArray(12, 11, 3)));
+        cerr << '.';
+    }
+
+    void test_threads() {
+        setEvaluationTileSize(64);
+        R2 serial(Region(image.bases(), IndexArray(image.base(0) + 44, image.base(1) + 7)));
+        copy(serial, resampleTo(image, SizeArray(45, 8), CubicResample));
+        setEvaluationThreadCount(4);
+        CPPUNIT_ASSERT(difference(serial, resampleTo(image, SizeArray(45, 8), CubicResample)) == 0.0);
+        cerr << '.';
+    }
+
+    // Overshooting filters must clamp to the range of the element type
+    void test_integer_elements() {
+        B2 b(image.bounds());
+        IndexArray idx(b.bases());
+        do {
+            b(idx) = ((idx[0] + idx[1]) % 2) ? 255 : 0;
+        } while (nextIndex(idx, b.bounds()));
+        ResampleFilter filters[] = { LinearResample, CubicResample, LanczosResample };
+        for (int f = 0; f < 3; ++f) {
+            MultiArrayRaster<double, 2> expected = naiveResample(b, SizeArray(47, 31), filters[f]);
+            idx = expected.bases();
+            do {
+                expected(idx) = std::floor(std::max(0.0, std::min(255.0, expected(idx))) + 0.5);
+            } while (nextIndex(idx, expected.bounds()));
+            CPPUNIT_ASSERT(difference(expected, resampleTo(b, SizeArray(47, 31), filters[f])) <= 1.0);
+        }
+        cerr << '.';
+    }
+
+    void test_flat() {
+        R2 flat(image.bounds()), expected;
+        fill(flat, 3.25f);
+        SizeArray sizes[] = { SizeArray(50, 3), SizeArray(7, 41) };
+        for (int s = 0; s < 2; ++s) {
+            expected.setBounds(Region(flat.bases(),
+                                      IndexArray(flat.base(0) + sizes[s][0] - 1,
+                                                 flat.base(1) + sizes[s][1] - 1)));
+            fill(expected, 3.25f);
+            CPPUNIT_ASSERT(difference(expected, resampleTo(flat, sizes[s], LanczosResample)) < 1e-5);
+            CPPUNIT_ASSERT(difference(expected, resampleTo(flat, sizes[s], BoxResample)) < 1e-5);
+        }
+        cerr << '.';
+    }
+
+protected:
+    R2              image;      // Some values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+    SizeType        tileSize;   // The evaluation tile size before the test
+};
+
+#endif
@@ -0,0 +1,222 @@
+/* -*- C++ -*-
+ *
+ * File: RasterSpanTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for span access. Runs of elements read with span() (including
+ *      runs hanging off either end of the raster, and runs lying entirely
+ *      outside of it) must match the same elements read one at a time, for
+ *      each out-of-bounds policy and for operators; and no core's getSpan()
+ *      may ever be asked for elements outside of its bounds. Runs written
+ *      with storeSpan() must change only the elements within bounds.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_SPAN
+#define TEST_RASTER_SPAN
+
+
+using namespace inca::raster;
+
+
+// Import the operators under test
+#include <inca/raster/operators/arithmetic>
+
+// Import containers
+#include <vector>
+
+// Import metaprogramming tools
+#include <inca/util/multi-dimensional-macros.hpp>
+#include <inca/util/metaprogramming/macros.hpp>
+
+
+namespace inca {
+    namespace raster {
+
+        // An operator that passes its operand through unchanged, but counts
+        // how many of the spans asked of its core leave its bounds
+        INCA_RASTER_OPERATOR_CLASS_HEADER(SpanCheckingOperatorRaster,
+                                          1, NIL,
+                                          typename R0::ElementType) {
+        public:
+            // Get types from the superclass
+            INCA_RASTER_OPERATOR_IMPORT_TYPES(SpanCheckingOperatorRaster<R0>)
+
+            // Constructor taking the operand and the counter to increment
+            SpanCheckingOperatorRaster(const R0 & r, SizeType & strays)
+                : OperatorBaseType(r), _strays(&strays) { }
+
+        protected:
+            INCA_RASTER_OPERATOR_GET_ELEMENT_HEADER(indices) {
+                return ReturnType(this->operand0(indices));
+            }
+
+            INCA_RASTER_OPERATOR_GET_SPAN_HEADER(indices, count, out) {
+                IndexArray first(indices), last(indices);
+                last[0] += count - 1;
+                if (! this->bounds().contains(first) || ! this->bounds().contains(last))
+                    ++*_strays;
+                this->operand0.span(first, count, out);
+            }
+
+            SizeType * _strays;
+        };
+
+    }
+}
+
+// Clean up the preprocessor's namespace
+#define UNDEFINE_INCA_MULTI_DIM_MACROS
+#include <inca/util/multi-dimensional-macros.hpp>
+#define UNDEFINE_INCA_METAPROGRAMMING_MACROS
+#include <inca/util/metaprogramming/macros.hpp>
+
+
+class RasterSpanTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterSpanTest                  ThisTest;
+    typedef MultiArrayRaster<float, 2>      R2;
+    typedef R2::Region                      Region;
+    typedef R2::IndexArray                  IndexArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Span tests
+        CPPUNIT_TEST(test_checked_spans);
+        CPPUNIT_TEST(test_operator_spans);
+        CPPUNIT_TEST(test_store_spans);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Spans: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        source = R2(Region(IndexArray(-4, 2), IndexArray(32, 12)));
+        IndexArray idx(source.bases());
+        do {
+            source(idx) = float((idx[0] * 31 + idx[1] * 17) % 23) - 0.25f * float(idx[1]);
+        } while (nextIndex(idx, source.bounds()));
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Read runs of several lengths, starting before, within and after 'r',
+    // on rows within and outside of it, and compare them with the same
+    // elements read one at a time
+    template <class R>
+    static bool spansMatchElements(const R & r) {
+        SizeType lengths[] = { 1, 5, r.size(0) + 6 };
+        std::vector<float> buffer;
+        IndexArray idx;
+        for (idx[1] = r.base(1) - 2; idx[1] <= r.extent(1) + 2; ++idx[1])
+            for (IndexType start = r.base(0) - 3; start <= r.extent(0) + 3; ++start)
+                for (int l = 0; l < 3; ++l) {
+                    buffer.resize(lengths[l]);
+                    idx[0] = start;
+                    r.span(idx, lengths[l], &buffer[0]);
+                    for (SizeType i = 0; i < lengths[l]; ++i) {
+                        IndexArray element(start + IndexType(i), idx[1]);
+                        if (buffer[i] != float(r(element)))
+                            return false;
+                    }
+                }
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Span tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_checked_spans() {
+        OutOfBoundsPolicy policies[] = { Constant, Nearest, Mirror, Wrap };
+        source.setOutOfBoundsValue(-1.0f);
+        for (int p = 0; p < 4; ++p) {
+            source.setOutOfBoundsPolicy(policies[p]);
+            CPPUNIT_ASSERT(spansMatchElements(source));
+        }
+        cerr << '.';
+    }
+
+    // Operators don't check their indices, so everything outside of their
+    // bounds must be read an element at a time
+    void test_operator_spans() {
+        source.setOutOfBoundsPolicy(Constant);
+        source.setOutOfBoundsValue(-1.0f);
+        SizeType strays = 0;
+        SpanCheckingOperatorRaster<R2> checked(source, strays);
+        CPPUNIT_ASSERT(spansMatchElements(checked));
+        CPPUNIT_ASSERT(spansMatchElements(checked * 2.0f + source));
+        CPPUNIT_ASSERT(spansMatchElements(
+            SpanCheckingOperatorRaster< SpanCheckingOperatorRaster<R2> >(checked, strays) - 1.0f));
+        CPPUNIT_ASSERT(strays == 0);
+
+        source.setOutOfBoundsPolicy(Nearest);
+        CPPUNIT_ASSERT(spansMatchElements(source * source - 3.0f));
+        cerr << '.';
+    }
+
+    // Only the elements within bounds get written
+    void test_store_spans() {
+        R2 expected(source.bounds());
+        copy(expected, source);
+        std::vector<float> values(source.size(0) + 10);
+        for (SizeType i = 0; i < values.size(); ++i)
+            values[i] = 1000.0f + float(i);
+
+        IndexArray start(source.base(0) - 4, source.base(1) + 3);
+        source.storeSpan(start, values.size(), &values[0]);
+        for (IndexType i = source.base(0); i <= source.extent(0); ++i)
+            expected(i, start[1]) = values[i - start[0]];
+
+        start = IndexArray(source.extent(0) - 2, source.base(1) + 5);
+        source.storeSpan(start, 10, &values[0]);
+        for (IndexType i = start[0]; i <= source.extent(0); ++i)
+            expected(i, start[1]) = values[i - start[0]];
+
+        start = IndexArray(source.base(0), source.extent(1) + 1);
+        source.storeSpan(start, 10, &values[0]);
+
+        IndexArray idx(source.bases());
+        do {
+            CPPUNIT_ASSERT(source(idx) == expected(idx));
+        } while (nextIndex(idx, source.bounds()));
+        cerr << '.';
+    }
+
+protected:
+    R2 source;      // Some values, based away from zero
+};
+
+#endif
@@ -0,0 +1,283 @@
+/* -*- C++ -*-
+ *
+ * File: RasterStaticTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for compile-time sized rasters. A StaticRaster must hold exactly
+ *      what a MultiArrayRaster copied from the same source holds, whether
+ *      read an element or a span at a time, in and around its bounds, in two
+ *      and three dimensions, and wherever it is moved to; spans written into
+ *      it must land in the same places. Unlike MultiArrayRasters, its copies
+ *      must not share elements. Convolving with one must give the same
+ *      answer as convolving with the same kernel held in a MultiArrayRaster,
+ *      and gaussianKernel() must sample a normalized Gaussian.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_STATIC
+#define TEST_RASTER_STATIC
+
+
+using namespace inca::raster;
+
+
+// Import the container under test
+#include <inca/raster/StaticRaster>
+#include <inca/raster/MultiArrayRaster>
+#include <inca/raster/generators/gaussian>
+
+// Import operators & algorithms to run over it
+#include <inca/raster/operators/convolve>
+#include <inca/raster/algorithms/copy>
+
+// Import containers & math functions
+#include <vector>
+#include <cmath>
+
+
+class RasterStaticTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterStaticTest                        ThisTest;
+    typedef MultiArrayRaster<float, 2>              R2;
+    typedef MultiArrayRaster<float, 3>              R3;
+    typedef StaticRaster<float, 7, 5>               S2;
+    typedef StaticRaster<float, 3, 4, 5>            S3;
+    typedef R2::Region                              Region;
+    typedef R2::IndexArray                          IndexArray;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Static raster tests
+        CPPUNIT_TEST(test_elements_2d);
+        CPPUNIT_TEST(test_elements_3d);
+        CPPUNIT_TEST(test_partial_conversion);
+        CPPUNIT_TEST(test_set_span);
+        CPPUNIT_TEST(test_bounds);
+        CPPUNIT_TEST(test_copies);
+        CPPUNIT_TEST(test_convolution);
+        CPPUNIT_TEST(test_gaussian_kernel);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Static Rasters: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        seed = 12345;
+        small = R2(Region(IndexArray(-3, 2), IndexArray(3, 6)));       // 7x5
+        scramble(small);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some numbers in [0, 1) with no particular structure, the same every time
+    template <class R>
+    void scramble(R & r) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // Do 'r' and 'expected' agree exactly, reading elements one at a time
+    // (in and around their bounds), and reading runs of several lengths from
+    // every starting point along each row, reaching beyond the bounds at
+    // either end?
+    template <class R, class E>
+    static bool same(const R & r, const E & expected) {
+        typedef typename R::IndexArray IndexArray;
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+
+        SizeType lengths[] = { 1, 3, r.size(0), r.size(0) + 6 };
+        std::vector<float> buffer;
+        typename R::Region around(r.bounds());
+        IndexArray lo(r.bases()), hi(r.extents());
+        for (IndexType d = 0; d < IndexType(R::dimensionality); ++d) {
+            lo[d] -= 2;
+            hi[d] += 2;
+        }
+        around.setBasesAndExtents(lo, hi);
+
+        IndexArray idx(around.bases());
+        do {
+            if (float(r(idx)) != float(expected(idx)))
+                return false;
+            for (int l = 0; l < 4; ++l) {
+                buffer.resize(lengths[l]);
+                r.span(idx, lengths[l], &buffer[0]);
+                IndexArray i(idx);
+                for (SizeType k = 0; k < lengths[l]; ++k, ++i[0])
+                    if (buffer[k] != float(expected(i)))
+                        return false;
+            }
+        } while (nextIndex(idx, around));
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Static raster tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_elements_2d() {
+        S2 s(small);
+        CPPUNIT_ASSERT(S2::elementCount == 35);
+        CPPUNIT_ASSERT(s.bases() == small.bases());
+        CPPUNIT_ASSERT(same(s, small));
+
+        // Elements are stored with dimension 0 fastest
+        CPPUNIT_ASSERT(S2::stride(0) == 1 && S2::stride(1) == 7);
+        CPPUNIT_ASSERT(s.elements()[2 * 7 + 3] == small(small.base(0) + 3, small.base(1) + 2));
+        cerr << '.';
+    }
+
+    void test_elements_3d() {
+        R3 volume(R3::Region(R3::IndexArray(4, -2, 0), R3::IndexArray(6, 1, 4)));
+        scramble(volume);
+        S3 s(volume);
+        CPPUNIT_ASSERT(S3::stride(2) == 12);
+        CPPUNIT_ASSERT(same(s, volume));
+        cerr << '.';
+    }
+
+    // Converting from a raster that doesn't cover it sets only the overlap
+    void test_partial_conversion() {
+        R2 part(Region(small.bases(), IndexArray(small.base(0) + 3, small.base(1) + 1)));
+        copy(part, small, part.bases(), part.extents());
+        S2 s(part);
+        CPPUNIT_ASSERT(s.bases() == small.bases());
+        IndexArray idx(part.bases());
+        do {
+            CPPUNIT_ASSERT(s(idx) == part(idx));
+        } while (nextIndex(idx, part.bounds()));
+        cerr << '.';
+    }
+
+    // Whole rows and pieces of rows, written as spans
+    void test_set_span() {
+        S2 s(0.0f);
+        s.setBases(small.bases());
+        R2 expected(small.bounds());
+        copy(s, small);
+        copy(expected, small);
+        CPPUNIT_ASSERT(same(s, expected));
+
+        float values[] = { -1.0f, -2.0f, -3.0f, -4.0f, -5.0f, -6.0f, -7.0f, -8.0f, -9.0f };
+        IndexType starts[] = { small.base(0) - 2, small.base(0) + 2, small.base(0) };
+        SizeType lengths[] = { 5, 3, 7 };
+        for (int r = 0; r < 3; ++r) {
+            IndexArray start(starts[r], small.base(1) + r + 1);
+            s.storeSpan(start, lengths[r], values);
+            expected.storeSpan(start, lengths[r], values);
+        }
+        CPPUNIT_ASSERT(same(s, expected));
+        cerr << '.';
+    }
+
+    // Moving it keeps its size & elements
+    void test_bounds() {
+        S2 s(small);
+        s.centerOnOrigin();
+        CPPUNIT_ASSERT(s.bases() == IndexArray(-3, -2) && s.extents() == IndexArray(3, 2));
+        R2 centered(s.bounds());
+        IndexArray idx(small.bases());
+        do {
+            centered(idx[0], idx[1] - 4) = small(idx);
+        } while (nextIndex(idx, small.bounds()));
+        CPPUNIT_ASSERT(same(s, centered));
+
+        s.setExtents(IndexArray(10, 20));
+        CPPUNIT_ASSERT(s.bases() == IndexArray(4, 16) && s.sizes() == small.sizes());
+        CPPUNIT_ASSERT(s(4, 16) == small(small.bases()));
+        cerr << '.';
+    }
+
+    // Copies are deep, unlike those of MultiArrayRasters
+    void test_copies() {
+        S2 a(small), b(a);
+        b(small.bases()) = -1.0f;
+        CPPUNIT_ASSERT(a(small.bases()) == small(small.bases()));
+        a = b;
+        CPPUNIT_ASSERT(a(small.bases()) == -1.0f);
+        a(small.bases()) = -2.0f;
+        CPPUNIT_ASSERT(b(small.bases()) == -1.0f);
+        cerr << '.';
+    }
+
+    void test_convolution() {
+        R2 image(Region(IndexArray(-4, 3), IndexArray(18, 19)));
+        scramble(image);
+        S2 k(small);
+        k.centerOnOrigin();
+        R2 expected(k.bounds());
+        copy(expected, k);
+        ConvolutionOperatorRaster<R2> a = convolve(image, k, DirectConvolution),
+                                      b = convolve(image, expected, DirectConvolution);
+        IndexArray idx(image.bases());
+        do {
+            CPPUNIT_ASSERT(std::abs(a(idx) - b(idx)) < 1e-5f);
+        } while (nextIndex(idx, image.bounds()));
+        cerr << '.';
+    }
+
+    // Centered, symmetric, summing to one, and shaped like a Gaussian
+    void test_gaussian_kernel() {
+        StaticRaster<double, 5, 7> k = gaussianKernel<double, 5, 7>(1.5);
+        typedef StaticRaster<double, 5, 7>::IndexArray KIndex;
+        CPPUNIT_ASSERT(k.bases() == KIndex(-2, -3) && k.extents() == KIndex(2, 3));
+        double sum = 0.0, expectedSum = 0.0;
+        KIndex idx(k.bases());
+        do {
+            sum += k(idx);
+            expectedSum += std::exp(-(idx[0] * idx[0] + idx[1] * idx[1]) / (2 * 1.5 * 1.5));
+            CPPUNIT_ASSERT(std::abs(k(idx) - k(-idx[0], -idx[1])) < 1e-12);
+        } while (nextIndex(idx, k.bounds()));
+        CPPUNIT_ASSERT(std::abs(sum - 1.0) < 1e-9);
+
+        idx = k.bases();
+        do {
+            double expected = std::exp(-(idx[0] * idx[0] + idx[1] * idx[1]) / (2 * 1.5 * 1.5))
+                            / expectedSum;
+            CPPUNIT_ASSERT(std::abs(k(idx) - expected) < 1e-9);
+        } while (nextIndex(idx, k.bounds()));
+        cerr << '.';
+    }
+
+protected:
+    R2              small;      // 7x5 values, based away from zero
+    unsigned int    seed;       // State of our random number generator
+};
+
+#endif
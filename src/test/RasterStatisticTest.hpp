@@ -0,0 +1,161 @@
+/* -*- C++ -*-
+ *
+ * File: RasterStatisticTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the raster statistics reducers. The count, sum, range,
+ *      mean and variance of rasters of integer and floating-point elements
+ *      are checked against values computed directly in double precision,
+ *      with one and with several evaluation threads.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_STATISTIC
+#define TEST_RASTER_STATISTIC
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/statistic>
+#include <inca/raster/algorithms/parallel>
+
+// Import math functions & numeric limits
+#include <cmath>
+#include <limits>
+
+
+class RasterStatisticTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterStatisticTest ThisTest;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Statistics tests
+        CPPUNIT_TEST(test_int_statistics);
+        CPPUNIT_TEST(test_byte_statistics);
+        CPPUNIT_TEST(test_float_statistics);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Statistics: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void tearDown() {
+        setEvaluationThreadCount(1);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Check statistics(r) against the mean & variance computed directly,
+    // allowing 'tolerance' for conversion to the element type (which clamps
+    // values that don't fit)
+    template <class R>
+    static void checkStatistics(const R & r, double tolerance) {
+        typedef typename R::ElementType T;
+        double sum = 0.0, m2 = 0.0;
+        T lo = r(r.bases()), hi = lo;
+        typename R::IndexArray idx;
+        for (idx[1] = r.base(1); idx[1] <= r.extent(1); ++idx[1])
+            for (idx[0] = r.base(0); idx[0] <= r.extent(0); ++idx[0]) {
+                sum += double(r(idx));
+                lo = std::min(lo, T(r(idx)));
+                hi = std::max(hi, T(r(idx)));
+            }
+        double mean = sum / double(r.size());
+        for (idx[1] = r.base(1); idx[1] <= r.extent(1); ++idx[1])
+            for (idx[0] = r.base(0); idx[0] <= r.extent(0); ++idx[0])
+                m2 += (double(r(idx)) - mean) * (double(r(idx)) - mean);
+        double variance = m2 / double(r.size());
+
+        for (SizeType threads = 1; threads <= 4; threads += 3) {
+            setEvaluationThreadCount(threads);
+            Statistics<T> s = statistics(r);
+            CPPUNIT_ASSERT(s.count() == r.size());
+            CPPUNIT_ASSERT(s.min() == lo);
+            CPPUNIT_ASSERT(s.max() == hi);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(sum, double(s.sum()), 1e-6 * std::fabs(sum));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, double(s.mean()), tolerance);
+            if (variance <= double(std::numeric_limits<T>::max()))
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(variance, double(s.variance()), tolerance);
+            else
+                CPPUNIT_ASSERT(s.variance() == std::numeric_limits<T>::max());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(std::sqrt(variance), double(s.stddev()), tolerance);
+        }
+        cerr << '.';
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Statistics tests
+ *---------------------------------------------------------------------------*/
+public:
+    // Half 0, half 100: the mean & variance are exact, but don't come out
+    // right if they're computed in integer arithmetic
+    void test_int_statistics() {
+        MultiArrayRaster<int, 2> r(MultiArrayRaster<int, 2>::SizeArray(40, 30));
+        for (IndexType j = 0; j < 30; ++j)
+            for (IndexType i = 0; i < 40; ++i)
+                r(i, j) = (j < 15) ? 0 : 100;
+
+        Statistics<int> s = statistics(r);
+        CPPUNIT_ASSERT(s.count() == 1200);
+        CPPUNIT_ASSERT(s.sum() == 60000.0);
+        CPPUNIT_ASSERT(s.mean() == 50);
+        CPPUNIT_ASSERT(s.variance() == 2500);
+        CPPUNIT_ASSERT(s.stddev() == 50);
+        CPPUNIT_ASSERT(variance(r) == 2500);
+        CPPUNIT_ASSERT(stddev(r) == 50);
+        checkStatistics(r, 0.0);
+    }
+
+    // More bytes than a byte can count
+    void test_byte_statistics() {
+        MultiArrayRaster<unsigned char, 2> r(MultiArrayRaster<unsigned char, 2>::SizeArray(300, 70));
+        for (IndexType j = 0; j < 70; ++j)
+            for (IndexType i = 0; i < 300; ++i)
+                r(i, j) = (unsigned char)((i * 7 + j * 3) % 256);
+        checkStatistics(r, 1.0);
+    }
+
+    void test_float_statistics() {
+        MultiArrayRaster<float, 2> r(MultiArrayRaster<float, 2>::SizeArray(257, 63));
+        for (IndexType j = 0; j < 63; ++j)
+            for (IndexType i = 0; i < 257; ++i)
+                r(i, j) = 1000.0f + float((i * 31 + j * 17) % 23) - 0.25f * float(j % 7);
+        checkStatistics(r, 1e-3);
+    }
+};
+
+#endif
@@ -0,0 +1,195 @@
+/* -*- C++ -*-
+ *
+ * File: RasterStencilTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for stencil fusion. Chains of derivatives and blurs built with
+ *      the factory functions (which fuse them) must match the same chains
+ *      built from the operator constructors (which don't), within and
+ *      outside of the source's bounds, and whether read an element or a
+ *      span at a time; rows are long enough to take several span buffers.
+ *      Merging coincident taps must leave the expected number behind.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_STENCIL
+#define TEST_RASTER_STENCIL
+
+
+using namespace inca::raster;
+
+
+// Import the operators under test
+#include <inca/raster/operators/derivative>
+#include <inca/raster/operators/blur>
+#include <inca/raster/operators/gradient>
+
+// Import containers & math functions
+#include <vector>
+#include <cmath>
+
+
+class RasterStencilTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterStencilTest                           ThisTest;
+    typedef MultiArrayRaster<float, 2>                  R2;
+    typedef R2::Region                                  Region;
+    typedef R2::IndexArray                              IndexArray;
+    typedef DerivativeOperatorRaster<R2>                D;
+    typedef BlurOperatorRaster<R2>                      B;
+    typedef StencilOperatorRaster<R2>                   Fused;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Stencil tests
+        CPPUNIT_TEST(test_derivative_chains);
+        CPPUNIT_TEST(test_blur_chains);
+        CPPUNIT_TEST(test_mixed_chains);
+        CPPUNIT_TEST(test_fuse);
+        CPPUNIT_TEST(test_gradient_of_fused);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Stencil Fusion: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        source = R2(Region(IndexArray(-5, 2), IndexArray(300, 13)));
+        unsigned int seed = 12345;
+        IndexArray idx(source.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            source(idx) = float((seed >> 16) % 1000) / 1000.0f;
+        } while (nextIndex(idx, source.bounds()));
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Do 'fused' and 'unfused' agree to within round-off, reading elements
+    // one at a time (in and around their bounds) and whole rows as spans?
+    template <class R0, class R1>
+    static bool same(const R0 & fused, const R1 & unfused) {
+        if (fused.bases() != unfused.bases() || fused.sizes() != unfused.sizes())
+            return false;
+        std::vector<float> a(fused.size(0) + 6), b(fused.size(0) + 6);
+        IndexArray idx;
+        for (idx[1] = fused.base(1) - 3; idx[1] <= fused.extent(1) + 3; ++idx[1]) {
+            for (idx[0] = fused.base(0) - 3; idx[0] <= fused.extent(0) + 3; ++idx[0])
+                if (std::abs(float(fused(idx)) - float(unfused(idx))) > 1e-5f)
+                    return false;
+            IndexArray start(fused.base(0) - 3, idx[1]);
+            fused.span(start, SizeType(a.size()), &a[0]);
+            unfused.span(start, SizeType(b.size()), &b[0]);
+            for (SizeType i = 0; i < SizeType(a.size()); ++i)
+                if (std::abs(a[i] - b[i]) > 1e-5f)
+                    return false;
+        }
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Stencil tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_derivative_chains() {
+        Fused dxy = d(d(source, 0), 1);
+        CPPUNIT_ASSERT(dxy.tapCount() == 4);
+        CPPUNIT_ASSERT(same(dxy, DerivativeOperatorRaster<D>(D(source, 0), 1)));
+
+        // The two center taps of d(d(r, x), x) merge, and so do the 8 reads
+        // of d(d(d(r, x), x), x), into 4 taps
+        Fused dxx = d(d(source, 0), 0), dxxx = d(dxx, 0);
+        CPPUNIT_ASSERT(dxx.tapCount() == 3);
+        CPPUNIT_ASSERT(dxxx.tapCount() == 4);
+        CPPUNIT_ASSERT(same(dxxx, DerivativeOperatorRaster< DerivativeOperatorRaster<D> >(
+                                    DerivativeOperatorRaster<D>(D(source, 0), 0), 0)));
+        cerr << '.';
+    }
+
+    // The blur clamps at the source's edges, so fusing it is only exact in
+    // the interior, and the edges must be evaluated stage by stage
+    void test_blur_chains() {
+        Fused bb = blur(blur(source));
+        CPPUNIT_ASSERT(bb.tapCount() == 25);
+        CPPUNIT_ASSERT(same(bb, BlurOperatorRaster<B>(B(source))));
+        CPPUNIT_ASSERT(same(blur(bb), BlurOperatorRaster< BlurOperatorRaster<B> >(
+                                        BlurOperatorRaster<B>(B(source)))));
+        cerr << '.';
+    }
+
+    void test_mixed_chains() {
+        CPPUNIT_ASSERT(same(d(blur(source), 1), DerivativeOperatorRaster<B>(B(source), 1)));
+        CPPUNIT_ASSERT(same(blur(d(source, 0)), BlurOperatorRaster<D>(D(source, 0))));
+        CPPUNIT_ASSERT(same(blur(d(d(source, 0), 1)),
+                            BlurOperatorRaster< DerivativeOperatorRaster<D> >(
+                                DerivativeOperatorRaster<D>(D(source, 0), 1))));
+        cerr << '.';
+    }
+
+    // A chain built by hand can be fused after the fact
+    void test_fuse() {
+        BlurOperatorRaster<D> chain(D(source, 1));
+        Fused fused = fuse(chain);
+        CPPUNIT_ASSERT(fused.stages().size() == 2);
+        CPPUNIT_ASSERT(same(fused, chain));
+
+        // Anything that isn't a chain is left alone
+        R2 r = fuse(source);
+        CPPUNIT_ASSERT(same(r, source));
+        cerr << '.';
+    }
+
+    // Operators that aren't stencils read a fused operand through its spans
+    void test_gradient_of_fused() {
+        GradientOperatorRaster<Fused> fused = gradient(blur(blur(source)));
+        GradientOperatorRaster< BlurOperatorRaster<B> > unfused
+            = gradient(BlurOperatorRaster<B>(B(source)));
+        typedef GradientOperatorRaster<Fused>::ElementType Vector;
+        std::vector<Vector> a(source.size(0)), b(source.size(0));
+        IndexArray idx(source.bases());
+        for (; idx[1] <= source.extent(1); ++idx[1]) {
+            fused.span(idx, SizeType(a.size()), &a[0]);
+            unfused.span(idx, SizeType(b.size()), &b[0]);
+            for (SizeType i = 0; i < SizeType(a.size()); ++i)
+                for (IndexType dim = 0; dim < 2; ++dim)
+                    CPPUNIT_ASSERT(std::abs(a[i][dim] - b[i][dim]) < 1e-5f);
+        }
+        cerr << '.';
+    }
+
+protected:
+    R2 source;      // Random values in [0, 1), based away from zero
+};
+
+#endif
@@ -0,0 +1,198 @@
+/* -*- C++ -*-
+ *
+ * File: RasterWarpTest
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Tests for the warp operator. Transforms that map elements exactly
+ *      onto elements (the identity, whole-element translations and quarter
+ *      turns) must reproduce the input exactly with every kind of
+ *      interpolation, whether read an element or a span at a time, and
+ *      must come out with the right bounds.
+ *
+ * Implementation note:
+ *      This file is designed to be included by IncaTestMain.cpp, and may not
+ *      work correctly otherwise, as it depends on IncaTestMain.cpp already
+ *      having included some other things.
+ */
+
+#ifndef TEST_RASTER_WARP
+#define TEST_RASTER_WARP
+
+
+using namespace inca::raster;
+
+
+// Import the operators & algorithms under test
+#include <inca/raster/operators/warp>
+#include <inca/raster/algorithms/copy>
+
+
+class RasterWarpTest : public CppUnit::TestFixture {
+private:
+    // Convenience typedefs
+    typedef RasterWarpTest                          ThisTest;
+    typedef MultiArrayRaster<unsigned char, 2>      R2;
+    typedef MultiArrayRaster<float, 3>              R3;
+    typedef R2::Region                              Region;
+    typedef R2::IndexArray                          IndexArray;
+    typedef inca::math::Matrix<float, 3, 3>         Matrix3;
+    typedef inca::math::Matrix<float, 4, 4>         Matrix4;
+
+
+public:
+
+    // Create CppUnit test suite
+    CPPUNIT_TEST_SUITE(ThisTest);
+        // Print a nice, friendly header for this suite
+        CPPUNIT_TEST(beginSuite);
+
+        // Warp tests
+        CPPUNIT_TEST(test_identity);
+        CPPUNIT_TEST(test_translation);
+        CPPUNIT_TEST(test_rotate_90);
+        CPPUNIT_TEST(test_translation_3d);
+
+        // Print a nice, friendly footer for this suite
+        CPPUNIT_TEST(endSuite);
+    CPPUNIT_TEST_SUITE_END();
+
+
+/*---------------------------------------------------------------------------*
+ | Test suite setup
+ *---------------------------------------------------------------------------*/
+public:
+    void beginSuite() {
+        cerr << "Testing Raster Warps: ";
+    }
+
+    void endSuite() {
+        cerr << endl;
+    }
+
+    void setUp() {
+        source = R2(Region(IndexArray(-5, 3), IndexArray(30, 22)));
+        scramble(source, 1);
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Helper functions
+ *---------------------------------------------------------------------------*/
+protected:
+    // Some values for 'r' with no particular structure
+    template <class R>
+    static void scramble(R & r, unsigned int seed) {
+        typename R::IndexArray idx(r.bases());
+        do {
+            seed = seed * 1103515245u + 12345u;
+            r(idx) = typename R::ElementType((seed >> 16) % 256);
+        } while (nextIndex(idx, r.bounds()));
+    }
+
+    // The N+1 x N+1 identity matrix
+    template <class M>
+    static M identity() {
+        M m;
+        for (IndexType i = 0; i < IndexType(M::rows); ++i)
+            for (IndexType j = 0; j < IndexType(M::cols); ++j)
+                m.rowCol(i, j) = (i == j) ? 1.0f : 0.0f;
+        return m;
+    }
+
+    // Does 'r' have the same bounds & elements as 'expected', whether read
+    // one at a time or a span at a time?
+    template <class R0, class R1>
+    static bool matches(const R0 & expected, const R1 & r) {
+        if (r.bases() != expected.bases() || r.sizes() != expected.sizes())
+            return false;
+        MultiArrayRaster<typename R1::ElementType, R1::dimensionality> spans(r.bounds());
+        copy(spans, r);
+        typename R0::IndexArray idx(expected.bases());
+        do {
+            if (expected(idx) != r(idx) || expected(idx) != spans(idx))
+                return false;
+        } while (nextIndex(idx, expected.bounds()));
+        return true;
+    }
+
+
+/*---------------------------------------------------------------------------*
+ | Warp tests
+ *---------------------------------------------------------------------------*/
+public:
+    void test_identity() {
+        Matrix3 m = identity<Matrix3>();
+        CPPUNIT_ASSERT(matches(source, warp(source, m, NearestWarp)));
+        CPPUNIT_ASSERT(matches(source, warp(source, m, LinearWarp)));
+        CPPUNIT_ASSERT(matches(source, warp(source, m, CubicWarp)));
+        cerr << '.';
+    }
+
+    // By (3, -2) elements, both with its own bounds, and with bounds
+    // bigger than the input, which must be filled in with the background
+    void test_translation() {
+        Matrix3 m = identity<Matrix3>();
+        m.rowCol(0, 2) = 3.0f;
+        m.rowCol(1, 2) = -2.0f;
+        R2 expected(Region(IndexArray(-2, 1), IndexArray(33, 20)));
+        IndexArray idx(source.bases());
+        do {
+            expected(IndexArray(idx[0] + 3, idx[1] - 2)) = source(idx);
+        } while (nextIndex(idx, source.bounds()));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, NearestWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, LinearWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, CubicWarp)));
+
+        R2 padded(Region(IndexArray(-6, -1), IndexArray(36, 22)));
+        idx = padded.bases();
+        do {
+            padded(idx) = expected.bounds().contains(idx) ? expected(idx) : 0;
+        } while (nextIndex(idx, padded.bounds()));
+        CPPUNIT_ASSERT(matches(padded, warp(source, m, padded.bounds(), LinearWarp)));
+        CPPUNIT_ASSERT(matches(padded, warp(source, m, padded.bounds(), CubicWarp)));
+        cerr << '.';
+    }
+
+    // A quarter turn counter-clockwise: (x, y) goes to (-y, x)
+    void test_rotate_90() {
+        Matrix3 m = identity<Matrix3>();
+        m.rowCol(0, 0) = 0.0f;  m.rowCol(0, 1) = -1.0f;
+        m.rowCol(1, 0) = 1.0f;  m.rowCol(1, 1) = 0.0f;
+        R2 expected(Region(IndexArray(-source.extent(1), source.base(0)),
+                           IndexArray(-source.base(1), source.extent(0))));
+        IndexArray idx(source.bases());
+        do {
+            expected(IndexArray(-idx[1], idx[0])) = source(idx);
+        } while (nextIndex(idx, source.bounds()));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, NearestWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, LinearWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(source, m, CubicWarp)));
+        cerr << '.';
+    }
+
+    void test_translation_3d() {
+        R3 r(R3::SizeArray(11, 9, 13));
+        scramble(r, 2);
+        Matrix4 m = identity<Matrix4>();
+        m.rowCol(0, 3) = -4.0f;
+        m.rowCol(2, 3) = 7.0f;
+        R3 expected(R3::Region(R3::IndexArray(-4, 0, 7), R3::IndexArray(6, 8, 19)));
+        R3::IndexArray idx(r.bases());
+        do {
+            expected(R3::IndexArray(idx[0] - 4, idx[1], idx[2] + 7)) = r(idx);
+        } while (nextIndex(idx, r.bounds()));
+        CPPUNIT_ASSERT(matches(expected, warp(r, m, NearestWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(r, m, LinearWarp)));
+        CPPUNIT_ASSERT(matches(expected, warp(r, m, CubicWarp)));
+        cerr << '.';
+    }
+
+protected:
+    R2 source;      // Bytes with no particular structure
+};
+
+#endif
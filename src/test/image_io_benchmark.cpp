@@ -0,0 +1,127 @@
+/*
+ * File: image_io_benchmark.cpp
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Benchmark for the image file codecs. This saves and loads a large
+ *      image in each of the supported formats (8-bit PGM & PPM, 16-bit PGM,
+ *      PFM and raw), reports the time and throughput of each, and verifies
+ *      that every image survives the round trip. Each format is also loaded
+ *      into a float raster (converting the samples), and streamed in bands.
+ *
+ *      Usage: image_io_benchmark [size] [repetitions] [directory]
+ */
+
+#include <inca/math/color.hpp>
+#include <inca/raster/MultiArrayRaster>
+#include <inca/raster/algorithms/image_io>
+using namespace inca::raster;
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+using namespace std;
+
+
+typedef inca::math::Color<unsigned char, inca::math::sRGB<false> > RGB8;
+
+
+// Fill a raster with a deterministic, non-trivial pattern
+template <class R>
+void initialize(R & r) {
+    typedef typename image_pixel_traits<typename R::ElementType>::Sample Sample;
+    Sample * e = reinterpret_cast<Sample *>(r.elements());
+    inca::SizeType n = r.size() * image_pixel_traits<typename R::ElementType>::channels;
+    for (inca::SizeType i = 0; i < n; ++i)
+        e[i] = Sample(float((i * 7919) % 1000) / 1000.0f * 250.0f);
+}
+
+// Report the time & throughput of an operation on 'bytes' of pixels
+void report(const char * what, double seconds, double bytes) {
+    cout << "    " << left << setw(20) << what << right
+         << fixed << setprecision(4) << seconds << " s   "
+         << setprecision(1) << bytes / seconds / (1024 * 1024) << " MB/s" << endl;
+}
+
+// Time saving & loading a raster in one format
+template <class R>
+bool benchmark(const char * name, const string & file, inca::SizeType size, int reps) {
+    typedef typename R::ElementType ElementType;
+    R original(size, size), loaded, converted;
+    MultiArrayRaster<float, 2> floats;
+    initialize(original);
+    double bytes = double(sizeof(ElementType)) * original.size();
+
+    cout << name << " (" << size << "x" << size << ", " << file << ")" << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+        saveImage(original, file);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    report("save", elapsed.count() / reps, bytes);
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+        loadImage(loaded, file);
+    elapsed = chrono::steady_clock::now() - start;
+    report("load", elapsed.count() / reps, bytes);
+
+    bool same = loaded.sizes() == original.sizes()
+             && memcmp(loaded.elements(), original.elements(), size_t(bytes)) == 0;
+
+    // Loading into a different type exercises the sample conversion
+    if (image_pixel_traits<ElementType>::channels == 1) {
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < reps; ++i)
+            loadImage(floats, file);
+        elapsed = chrono::steady_clock::now() - start;
+        report("load as float", elapsed.count() / reps, bytes);
+    }
+
+    // Streaming in bands of 64 rows
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        ImageReader in(file);
+        R band;
+        while (in.rowsRemaining() > 0) {
+            band.setBounds(in.nextRows(64));
+            in.readRows(band, band.size(1));
+        }
+    }
+    elapsed = chrono::steady_clock::now() - start;
+    report("load in bands", elapsed.count() / reps, bytes);
+
+    remove(file.c_str());
+    if (! same)
+        cout << "    ROUND TRIP MISMATCH" << endl;
+    return same;
+}
+
+int main(int argc, char **argv) {
+    inca::SizeType size = (argc > 1) ? atoi(argv[1]) : 4096;
+    int reps            = (argc > 2) ? atoi(argv[2]) : 3;
+    string dir          = (argc > 3) ? argv[3] : ".";
+
+    bool ok = true;
+    ok = benchmark< MultiArrayRaster<unsigned char, 2> >
+            ("8-bit gray", dir + "/bench8.pgm", size, reps) && ok;
+    ok = benchmark< MultiArrayRaster<unsigned short, 2> >
+            ("16-bit gray", dir + "/bench16.pgm", size, reps) && ok;
+    ok = benchmark< MultiArrayRaster<RGB8, 2> >
+            ("8-bit RGB", dir + "/bench.ppm", size, reps) && ok;
+    ok = benchmark< MultiArrayRaster<float, 2> >
+            ("float gray", dir + "/bench.pfm", size, reps) && ok;
+    ok = benchmark< MultiArrayRaster<float, 2> >
+            ("float raw", dir + "/bench.raw", size, reps) && ok;
+
+    if (! ok)
+        cerr << "Some images did not survive the round trip!" << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/*
+ * File: raster_parallel_benchmark.cpp
+ *
+ * Author: Ryan L. Saunders
+ *
+ * Copyright 2004, Ryan L. Saunders. All rights reserved.
+ *
+ * Description:
+ *      Benchmark for the tiled, multithreaded raster evaluation engine. This
+ *      evaluates a linear_map(clamp(a * b + c)) expression into 2D and 3D
+ *      MultiArrayRasters with increasing numbers of threads, reports the
+ *      time and speedup relative to serial evaluation, and verifies that
+ *      every parallel result is identical to the serial one.
+ *
+ *      Usage: raster_parallel_benchmark [2D size] [3D size] [repetitions]
+ */
+
+#include <inca/raster/MultiArrayRaster>
+#include <inca/raster/operators/arithmetic>
+#include <inca/raster/operators/clamp>
+#include <inca/raster/operators/linear_map>
+#include <inca/raster/algorithms/parallel>
+using namespace inca::raster;
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+
+typedef MultiArrayRaster<float, 2> Image;
+typedef MultiArrayRaster<float, 3> HyperImage;
+
+
+// Fill a raster with a deterministic, non-trivial pattern
+template <class R>
+void initialize(R & r, float seed) {
+    float * e = r.elements();
+    for (inca::SizeType i = 0; i < r.size(); ++i)
+        e[i] = float((i * 7919 + int(seed * 104729)) % 1000) / 1000.0f;
+}
+
+// Time the evaluation of the test expression into 'dst'
+template <class R>
+double evaluate(R & dst, const R & a, const R & b, const R & c, int reps) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+        dst = linear_map(clamp(a * b + c, 0.25f, 1.25f), 0.25f, 1.25f, 0.0f, 255.0f);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / reps;
+}
+
+// Run the scaling test for one raster type
+template <class R>
+bool benchmark(const char * name, const typename R::SizeArray & sizes, int reps) {
+    R a(sizes), b(sizes), c(sizes), serial(sizes), parallel(sizes);
+    initialize(a, 1.0f);
+    initialize(b, 2.0f);
+    initialize(c, 3.0f);
+
+    cout << name << " (" << a.size() << " elements)" << endl;
+
+    setEvaluationThreadCount(1);
+    double base = evaluate(serial, a, b, c, reps);
+    cout << "    threads  " << setw(2) << 1 << ": "
+         << fixed << setprecision(4) << base << " s" << endl;
+
+    bool identical = true;
+    inca::SizeType maxThreads = inca::SizeType(std::thread::hardware_concurrency());
+    for (inca::SizeType t = 2; t <= maxThreads; t *= 2) {
+        setEvaluationThreadCount(t);
+        double time = evaluate(parallel, a, b, c, reps);
+        bool same = memcmp(serial.elements(), parallel.elements(),
+                           sizeof(float) * serial.size()) == 0;
+        identical = identical && same;
+        cout << "    threads  " << setw(2) << t << ": "
+             << fixed << setprecision(4) << time << " s   speedup "
+             << setprecision(2) << base / time << "x"
+             << (same ? "" : "   MISMATCH") << endl;
+    }
+    setEvaluationThreadCount(1);
+    return identical;
+}
+
+int main(int argc, char **argv) {
+    inca::SizeType size2D = (argc > 1) ? atoi(argv[1]) : 4096;
+    inca::SizeType size3D = (argc > 2) ? atoi(argv[2]) : 256;
+    int reps              = (argc > 3) ? atoi(argv[3]) : 3;
+
+    bool ok = true;
+    ok = benchmark<Image>("2D", Image::SizeArray(size2D, size2D), reps) && ok;
+    ok = benchmark<HyperImage>("3D", HyperImage::SizeArray(size3D, size3D, size3D), reps) && ok;
+
+    if (! ok)
+        cerr << "Parallel results differ from serial results!" << endl;
+    return ok ? 0 : 1;
+}
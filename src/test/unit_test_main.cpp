@@ -52,6 +52,25 @@ using namespace inca;
 #if TEST_INCA_RASTER
 #   include <inca/raster.hpp>
 #   include "RasterMetafunctionTest.hpp"
+#   include "RasterSpanTest.hpp"
+#   include "RasterConcurrencyTest.hpp"
+#   include "RasterCacheTest.hpp"
+#   include "RasterStencilTest.hpp"
+#   include "RasterResampleTest.hpp"
+#   include "RasterPyramidTest.hpp"
+#   include "RasterBrickedTest.hpp"
+#   include "RasterFlatTest.hpp"
+#   include "RasterStaticTest.hpp"
+#   include "RasterStatisticTest.hpp"
+#   include "RasterMappedTest.hpp"
+#   include "RasterMorphologyTest.hpp"
+#   include "RasterLabelingTest.hpp"
+#   include "RasterIntegralTest.hpp"
+#   include "RasterIsosurfaceTest.hpp"
+#   include "RasterWarpTest.hpp"
+#   include "RasterFourierTest.hpp"
+#   include "RasterConvolveTest.hpp"
+#   include "RasterBlurTest.hpp"
 #endif
 
 
@@ -120,6 +139,25 @@ int main(int argc, char **argv) {
  *---------------------------------------------------------------------------*/
 #if TEST_INCA_RASTER
     runner.addTest(RasterMetafunctionTest::suite());
+    runner.addTest(RasterSpanTest::suite());
+    runner.addTest(RasterConcurrencyTest::suite());
+    runner.addTest(RasterCacheTest::suite());
+    runner.addTest(RasterStencilTest::suite());
+    runner.addTest(RasterResampleTest::suite());
+    runner.addTest(RasterPyramidTest::suite());
+    runner.addTest(RasterBrickedTest::suite());
+    runner.addTest(RasterFlatTest::suite());
+    runner.addTest(RasterStaticTest::suite());
+    runner.addTest(RasterStatisticTest::suite());
+    runner.addTest(RasterMappedTest::suite());
+    runner.addTest(RasterMorphologyTest::suite());
+    runner.addTest(RasterLabelingTest::suite());
+    runner.addTest(RasterIntegralTest::suite());
+    runner.addTest(RasterIsosurfaceTest::suite());
+    runner.addTest(RasterWarpTest::suite());
+    runner.addTest(RasterFourierTest::suite());
+    runner.addTest(RasterConvolveTest::suite());
+    runner.addTest(RasterBlurTest::suite());
 #endif
 
 